@@ -4,6 +4,17 @@
 #include <cmath>
 #include <algorithm>
 #include <set>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <climits>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 using namespace std;
 
 const float EPS = 1e-3;
@@ -98,39 +109,76 @@ struct CoincidentGroup
     }
 };
 
-vector<CoincidentGroup> findCoincidentGroups(const vector<pts> &points)
+long long cellCoord(float v)
+{
+    return (long long)floor((double)v / (double)EPS);
+}
+
+unsigned long long cellKey(long long cx, long long cy)
 {
-    vector<CoincidentGroup> coincidentGroups;
+    return ((unsigned long long)cx << 32) ^ ((unsigned long long)cy & 0xffffffffULL);
+}
+
+// Assigns every point to the first earlier representative it coincides with,
+// or makes it a new representative. Representatives are bucketed in an EPS
+// sized grid, so only the 3x3 neighbourhood of a point has to be searched.
+vector<int> assignCoincidentGroups(const vector<pts> &points, vector<int> &representatives)
+{
+    vector<int> groupOf(points.size());
+    unordered_map<unsigned long long, vector<int>> grid;
+    grid.reserve(points.size());
+    representatives.clear();
 
     for (size_t i = 0; i < points.size(); i++)
     {
-        bool alreadyGrouped = false;
-        for (auto &group : coincidentGroups)
-        {
-            if (points[i] == group.representative)
-            {
-                group.originalIndices.push_back(points[i].originalIndex);
-                alreadyGrouped = true;
-                break;
-            }
-        }
+        long long cx = cellCoord(points[i].x);
+        long long cy = cellCoord(points[i].y);
+        int group = -1;
 
-        if (!alreadyGrouped)
+        for (long long dx = -1; dx <= 1; dx++)
         {
-            CoincidentGroup newGroup;
-            newGroup.representative = points[i];
-            newGroup.originalIndices.push_back(points[i].originalIndex);
-
-            for (size_t j = i + 1; j < points.size(); j++)
+            for (long long dy = -1; dy <= 1; dy++)
             {
-                if (points[i] == points[j])
+                auto it = grid.find(cellKey(cx + dx, cy + dy));
+                if (it == grid.end())
+                    continue;
+
+                for (int g : it->second)
                 {
-                    newGroup.originalIndices.push_back(points[j].originalIndex);
+                    if ((group == -1 || g < group) && points[i] == points[representatives[g]])
+                    {
+                        group = g;
+                        break;
+                    }
                 }
             }
+        }
 
-            coincidentGroups.push_back(newGroup);
+        if (group == -1)
+        {
+            group = representatives.size();
+            representatives.push_back(i);
+            grid[cellKey(cx, cy)].push_back(group);
         }
+        groupOf[i] = group;
+    }
+
+    return groupOf;
+}
+
+vector<CoincidentGroup> findCoincidentGroups(const vector<pts> &points)
+{
+    vector<int> representatives;
+    vector<int> groupOf = assignCoincidentGroups(points, representatives);
+
+    vector<CoincidentGroup> coincidentGroups(representatives.size());
+    for (size_t g = 0; g < representatives.size(); g++)
+    {
+        coincidentGroups[g].representative = points[representatives[g]];
+    }
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        coincidentGroups[groupOf[i]].originalIndices.push_back(points[i].originalIndex);
     }
 
     return coincidentGroups;
@@ -138,23 +186,14 @@ vector<CoincidentGroup> findCoincidentGroups(const vector<pts> &points)
 
 vector<pts> removeDuplicates(const vector<pts> &points)
 {
-    vector<pts> unique_points;
+    vector<int> representatives;
+    assignCoincidentGroups(points, representatives);
 
-    for (const auto &point : points)
+    vector<pts> unique_points;
+    unique_points.reserve(representatives.size());
+    for (int idx : representatives)
     {
-        bool isDuplicate = false;
-        for (const auto &unique_point : unique_points)
-        {
-            if (point == unique_point)
-            {
-                isDuplicate = true;
-                break;
-            }
-        }
-        if (!isDuplicate)
-        {
-            unique_points.push_back(point);
-        }
+        unique_points.push_back(points[idx]);
     }
 
     return unique_points;
@@ -201,55 +240,346 @@ bool isPointOnLine(const pts &point, const Line &line)
     }
 }
 
-vector<Line> findCollinearGroups(const vector<pts> &points)
+struct Direction
+{
+    double dx, dy;
+    int idx;
+};
+
+// Directions are folded into the half-plane dx > 0 (or dx == 0, dy > 0) so a
+// point and its mirror through the anchor fall into the same bucket.
+Direction makeDirection(const pts &anchor, const pts &p, int idx)
+{
+    Direction d;
+    d.dx = (double)p.x - anchor.x;
+    d.dy = (double)p.y - anchor.y;
+    d.idx = idx;
+    if (d.dx < 0 || (d.dx == 0 && d.dy < 0))
+    {
+        d.dx = -d.dx;
+        d.dy = -d.dy;
+    }
+    return d;
+}
+
+bool directionLess(const Direction &a, const Direction &b)
+{
+    return a.dx * b.dy - a.dy * b.dx > 0;
+}
+
+// True when the nearer of the two points lies within EPS of the line through
+// the anchor and the farther one.
+bool sameDirection(const Direction &a, const Direction &b)
+{
+    double longest = max(a.dx * a.dx + a.dy * a.dy, b.dx * b.dx + b.dy * b.dy);
+    return fabs(a.dx * b.dy - a.dy * b.dx) < EPS * sqrt(longest);
+}
+
+// Emits every maximal line of at least three points whose lowest index is
+// `anchor`, by sorting the other points around it and scanning runs of
+// consecutive directions that agree within EPS.
+vector<Line> findLinesThroughAnchor(const vector<pts> &points, size_t anchor)
 {
     vector<Line> lines;
-    vector<bool> used(points.size(), false);
+    vector<Direction> dirs;
+    dirs.reserve(points.size() - 1);
+    for (size_t j = 0; j < points.size(); j++)
+    {
+        if (j != anchor)
+            dirs.push_back(makeDirection(points[anchor], points[j], j));
+    }
+    if (dirs.size() < 2)
+        return lines;
+
+    sort(dirs.begin(), dirs.end(), directionLess);
+
+    // Near-vertical runs straddle both ends of the sorted order, so start the
+    // cyclic scan at the first run boundary.
+    size_t m = dirs.size();
+    size_t start = 0;
+    while (start < m && sameDirection(dirs[(start + m - 1) % m], dirs[start]))
+        start++;
+    if (start == m)
+        start = 0;
+
+    size_t t = 0;
+    while (t < m)
+    {
+        const Direction &first = dirs[(start + t) % m];
+        vector<int> run(1, first.idx);
+        bool lowestAnchor = (size_t)first.idx > anchor;
+        size_t u = t + 1;
+        while (u < m && sameDirection(dirs[(start + u - 1) % m], dirs[(start + u) % m]))
+        {
+            int idx = dirs[(start + u) % m].idx;
+            run.push_back(idx);
+            if ((size_t)idx < anchor)
+                lowestAnchor = false;
+            u++;
+        }
+        t = u;
 
-    for (size_t i = 0; i < points.size(); i++)
+        if (run.size() < 2 || !lowestAnchor)
+            continue;
+
+        sort(run.begin(), run.end());
+        Line line = createLineFromTwoPoints(points[anchor], points[run[0]]);
+        for (size_t r = 1; r < run.size(); r++)
+        {
+            line.points.push_back(points[run[r]]);
+        }
+        lines.push_back(line);
+    }
+
+    sort(lines.begin(), lines.end(), [](const Line &a, const Line &b)
+         { return a.points[1].originalIndex < b.points[1].originalIndex; });
+    return lines;
+}
+
+// With an EPS tolerance a later anchor can see a subset of a line that an
+// earlier anchor already emitted; keep only lines that add a new point pairing.
+vector<Line> dropContainedLines(const vector<Line> &candidates)
+{
+    vector<Line> lines;
+    unordered_map<int, vector<int>> linesOfPoint;
+
+    for (const auto &line : candidates)
     {
-        if (used[i])
+        bool contained = false;
+        auto it = linesOfPoint.find(line.points[0].originalIndex);
+        if (it != linesOfPoint.end())
+        {
+            for (int id : it->second)
+            {
+                const vector<pts> &host = lines[id].points;
+                bool all = true;
+                for (const auto &p : line.points)
+                {
+                    auto pos = lower_bound(host.begin(), host.end(), p, [](const pts &a, const pts &b)
+                                           { return a.originalIndex < b.originalIndex; });
+                    if (pos == host.end() || pos->originalIndex != p.originalIndex)
+                    {
+                        all = false;
+                        break;
+                    }
+                }
+                if (all)
+                {
+                    contained = true;
+                    break;
+                }
+            }
+        }
+
+        if (contained)
             continue;
 
-        for (size_t j = i + 1; j < points.size(); j++)
+        for (const auto &p : line.points)
         {
-            if (used[j])
-                continue;
+            linesOfPoint[p.originalIndex].push_back(lines.size());
+        }
+        lines.push_back(line);
+    }
+
+    return lines;
+}
+
+// Anchors are independent, so workers pull blocks of anchors from a shared
+// counter. Per-anchor results are concatenated in anchor order before the
+// merge pass, which makes the output identical for any thread count.
+vector<Line> findCollinearGroups(const vector<pts> &points, unsigned threads = 0)
+{
+    const size_t ANCHOR_BLOCK = 16;
+    size_t n = points.size();
+
+    if (threads == 0)
+        threads = max(1u, thread::hardware_concurrency());
+    threads = min<size_t>(threads, (n + ANCHOR_BLOCK - 1) / ANCHOR_BLOCK);
+
+    vector<vector<Line>> byAnchor(n);
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        size_t begin;
+        while ((begin = next.fetch_add(ANCHOR_BLOCK)) < n)
+        {
+            size_t end = min(n, begin + ANCHOR_BLOCK);
+            for (size_t i = begin; i < end; i++)
+                byAnchor[i] = findLinesThroughAnchor(points, i);
+        }
+    };
+
+    if (threads <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        vector<thread> pool;
+        for (unsigned t = 0; t < threads; t++)
+            pool.emplace_back(worker);
+        for (auto &th : pool)
+            th.join();
+    }
+
+    vector<Line> candidates;
+    for (auto &anchored : byAnchor)
+    {
+        candidates.insert(candidates.end(), anchored.begin(), anchored.end());
+    }
+
+    return dropContainedLines(candidates);
+}
+
+size_t countOnLine(const float *xs, const float *ys, size_t n,
+                   float ax, float ay, float dx, float dy, float tol)
+{
+    size_t count = 0;
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256 vax = _mm256_set1_ps(ax), vay = _mm256_set1_ps(ay);
+    const __m256 vdx = _mm256_set1_ps(dx), vdy = _mm256_set1_ps(dy);
+    const __m256 vtol = _mm256_set1_ps(tol);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 px = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vax);
+        __m256 py = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vay);
+        __m256 cross = _mm256_sub_ps(_mm256_mul_ps(vdx, py), _mm256_mul_ps(vdy, px));
+        __m256 on = _mm256_cmp_ps(_mm256_and_ps(cross, absMask), vtol, _CMP_LT_OQ);
+        count += __builtin_popcount(_mm256_movemask_ps(on));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        float cross = dx * (ys[i] - ay) - dy * (xs[i] - ax);
+        count += fabs(cross) < tol;
+    }
+    return count;
+}
+
+// Re-fits a candidate through its two extreme support points and keeps the
+// support that is within EPS of that line, using double precision.
+vector<int> refineSupport(const vector<pts> &points, const vector<int> &support)
+{
+    const pts &a = points[support[0]];
+    double ux = (double)points[support[1]].x - a.x;
+    double uy = (double)points[support[1]].y - a.y;
+
+    int lo = support[0], hi = support[0];
+    double loT = 0, hiT = 0;
+    for (int idx : support)
+    {
+        double t = ((double)points[idx].x - a.x) * ux + ((double)points[idx].y - a.y) * uy;
+        if (t < loT)
+        {
+            loT = t;
+            lo = idx;
+        }
+        if (t > hiT)
+        {
+            hiT = t;
+            hi = idx;
+        }
+    }
+
+    double dx = (double)points[hi].x - points[lo].x;
+    double dy = (double)points[hi].y - points[lo].y;
+    double tol = EPS * sqrt(dx * dx + dy * dy);
+
+    vector<int> refined;
+    for (int idx : support)
+    {
+        double cross = dx * ((double)points[idx].y - points[lo].y) - dy * ((double)points[idx].x - points[lo].x);
+        if (fabs(cross) < tol)
+            refined.push_back(idx);
+    }
+    return refined;
+}
 
-            if (points[i] == points[j])
+// Sampling-based search for lines carrying at least minPoints of the (unique)
+// input points. Random pairs are scored with countOnLine; a line with that
+// much support is found with probability `confidence`, then verified by
+// refineSupport and its points are removed before searching for the next one.
+// The number of trials per line is capped at MAX_LINE_TRIALS, which bounds the
+// search when confidence is close to 1 or no line has enough support.
+const double MAX_LINE_TRIALS = 1e6;
+
+vector<Line> findHeavyLines(const vector<pts> &points, size_t minPoints, double confidence, unsigned seed)
+{
+    vector<Line> lines;
+    if (minPoints < 3)
+        minPoints = 3;
+
+    mt19937 rng(seed);
+    vector<int> remaining(points.size());
+    for (size_t i = 0; i < points.size(); i++)
+        remaining[i] = i;
+
+    vector<float> xs, ys;
+    while (remaining.size() >= minPoints)
+    {
+        size_t n = remaining.size();
+        xs.resize(n);
+        ys.resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            xs[i] = points[remaining[i]].x;
+            ys[i] = points[remaining[i]].y;
+        }
+
+        double w = (double)minPoints / n * (double)(minPoints - 1) / (n - 1);
+        double trials = w >= 1 ? 1 : min(MAX_LINE_TRIALS, ceil(log(1 - confidence) / log(1 - w)));
+        uniform_int_distribution<size_t> pick(0, n - 1);
+
+        vector<int> best;
+        for (double t = 0; t < trials; t++)
+        {
+            size_t i = pick(rng), j = pick(rng);
+            if (i == j || points[remaining[i]] == points[remaining[j]])
                 continue;
 
-            Line currentLine = createLineFromTwoPoints(points[i], points[j]);
+            float dx = xs[j] - xs[i], dy = ys[j] - ys[i];
+            float tol = EPS * sqrt(dx * dx + dy * dy);
+            if (countOnLine(xs.data(), ys.data(), n, xs[i], ys[i], dx, dy, tol) < minPoints)
+                continue;
 
-            for (size_t k = 0; k < points.size(); k++)
+            vector<int> support;
+            support.push_back(remaining[i]);
+            support.push_back(remaining[j]);
+            for (size_t k = 0; k < n; k++)
             {
-                if (k == i || k == j || used[k])
+                if (k == i || k == j)
                     continue;
-
-                if (isPointOnLine(points[k], currentLine))
-                {
-                    currentLine.points.push_back(points[k]);
-                }
+                if (fabs(dx * (ys[k] - ys[i]) - dy * (xs[k] - xs[i])) < tol)
+                    support.push_back(remaining[k]);
             }
 
-            if (currentLine.points.size() >= 2)
+            support = refineSupport(points, support);
+            if (support.size() >= minPoints)
             {
-                for (const auto &p : currentLine.points)
-                {
-                    for (size_t idx = 0; idx < points.size(); idx++)
-                    {
-                        if (points[idx].x == p.x && points[idx].y == p.y &&
-                            points[idx].originalIndex == p.originalIndex)
-                        {
-                            used[idx] = true;
-                            break;
-                        }
-                    }
-                }
-                lines.push_back(currentLine);
+                best = support;
                 break;
             }
         }
+
+        if (best.empty())
+            break;
+
+        sort(best.begin(), best.end());
+        Line line = createLineFromTwoPoints(points[best[0]], points[best[1]]);
+        for (size_t r = 2; r < best.size(); r++)
+            line.points.push_back(points[best[r]]);
+        lines.push_back(line);
+
+        vector<int> kept;
+        kept.reserve(n - best.size());
+        for (int idx : remaining)
+        {
+            if (!binary_search(best.begin(), best.end(), idx))
+                kept.push_back(idx);
+        }
+        remaining.swap(kept);
     }
 
     return lines;
@@ -279,10 +609,15 @@ vector<pts> findIsolatedPoints(const vector<pts> &allPoints, const vector<Line>
     return isolated;
 }
 
-void analyzePoints(const vector<pts> &points)
+void analyzePoints(const vector<pts> &points, unsigned threads = 0)
 {
-    vector<pts> uniquePoints = removeDuplicates(points);
     vector<CoincidentGroup> coincidentGroups = findCoincidentGroups(points);
+    vector<pts> uniquePoints;
+    uniquePoints.reserve(coincidentGroups.size());
+    for (const auto &group : coincidentGroups)
+    {
+        uniquePoints.push_back(group.representative);
+    }
 
     cout << "=== POINT ANALYSIS ===" << endl;
     cout << "Original points: " << points.size() << endl;
@@ -331,7 +666,7 @@ void analyzePoints(const vector<pts> &points)
         return;
     }
 
-    vector<Line> collinearGroups = findCollinearGroups(uniquePoints);
+    vector<Line> collinearGroups = findCollinearGroups(uniquePoints, threads);
     vector<pts> isolatedPoints = findIsolatedPoints(uniquePoints, collinearGroups);
 
     cout << "\n=== COLLINEAR GROUPS ===" << endl;
@@ -385,12 +720,242 @@ void analyzePoints(const vector<pts> &points)
     }
 }
 
+const size_t STREAM_CHUNK = 4096;
+
+// Returns the position of the first point in the chunk that is farther than
+// `tol` (scaled by |b - a|) from the line through the anchors, or -1.
+long long firstOffLine(const float *xs, const float *ys, size_t n,
+                       float ax, float ay, float dx, float dy, float tol)
+{
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256 vax = _mm256_set1_ps(ax), vay = _mm256_set1_ps(ay);
+    const __m256 vdx = _mm256_set1_ps(dx), vdy = _mm256_set1_ps(dy);
+    const __m256 vtol = _mm256_set1_ps(tol);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 px = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vax);
+        __m256 py = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vay);
+        __m256 cross = _mm256_sub_ps(_mm256_mul_ps(vdx, py), _mm256_mul_ps(vdy, px));
+        __m256 off = _mm256_cmp_ps(_mm256_and_ps(cross, absMask), vtol, _CMP_GE_OQ);
+        int mask = _mm256_movemask_ps(off);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        float cross = dx * (ys[i] - ay) - dy * (xs[i] - ax);
+        if (fabs(cross) >= tol)
+            return i;
+    }
+    return -1;
+}
+
+// Answers "are all points collinear or coincident?" without storing the
+// input: points are read in fixed-size SoA chunks and tested against the
+// line through the first two distinct points, stopping at the first miss.
+int streamCollinearVerdict(const string &filename)
+{
+    ifstream file(filename);
+    if (!file.is_open())
+    {
+        cout << "Error: Could not open file " << filename << endl;
+        return 1;
+    }
+
+    vector<float> xs(STREAM_CHUNK), ys(STREAM_CHUNK);
+    pts a, b;
+    bool haveA = false, haveB = false;
+    float tol = 0;
+    long long total = 0;
+
+    float x, y;
+    char comma;
+    bool more = true;
+    while (more)
+    {
+        size_t n = 0;
+        while (n < STREAM_CHUNK && (more = (bool)(file >> x >> comma >> y)))
+        {
+            xs[n] = x;
+            ys[n] = y;
+            n++;
+        }
+
+        size_t begin = 0;
+        while (!haveB && begin < n)
+        {
+            pts p(xs[begin], ys[begin], total + begin);
+            if (!haveA)
+            {
+                a = p;
+                haveA = true;
+            }
+            else if (!(p == a))
+            {
+                b = p;
+                haveB = true;
+                tol = EPS * sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+            }
+            begin++;
+        }
+
+        if (haveB && begin < n)
+        {
+            long long off = firstOffLine(xs.data() + begin, ys.data() + begin, n - begin,
+                                         a.x, a.y, b.x - a.x, b.y - a.y, tol);
+            if (off >= 0)
+            {
+                long long pos = total + begin + off;
+                cout << "Result: NOT all points are collinear" << endl;
+                cout << "First non-collinear point at position " << pos << ": ";
+                pts(xs[begin + off], ys[begin + off], pos).print();
+                cout << endl;
+                return 0;
+            }
+        }
+        total += n;
+    }
+
+    if (!haveA)
+    {
+        cout << "No points found in file." << endl;
+        return 1;
+    }
+
+    cout << "Points read: " << total << endl;
+    if (!haveB)
+        cout << "Result: All points are COINCIDENT (same point)" << endl;
+    else
+        cout << "Result: ALL points are COLLINEAR" << endl;
+    return 0;
+}
+
+int reportHeavyLines(const string &filename, double threshold, double confidence, unsigned seed)
+{
+    vector<pts> points = readPoints(filename);
+    if (points.empty())
+    {
+        cout << "No points found in file." << endl;
+        return 1;
+    }
+
+    vector<pts> uniquePoints = removeDuplicates(points);
+    size_t minPoints = threshold < 1 ? (size_t)ceil(threshold * uniquePoints.size()) : (size_t)threshold;
+
+    vector<Line> lines = findHeavyLines(uniquePoints, minPoints, confidence, seed);
+
+    cout << "=== HEAVY LINES ===" << endl;
+    cout << "Unique points: " << uniquePoints.size() << endl;
+    cout << "Minimum points per line: " << max<size_t>(minPoints, 3) << endl;
+    cout << "Confidence: " << confidence << ", seed: " << seed << endl;
+    if (lines.empty())
+    {
+        cout << "No line with enough points found" << endl;
+    }
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        cout << "Group " << (i + 1) << ": ";
+        lines[i].print();
+    }
+    return 0;
+}
+
+void runBenchmark()
+{
+    mt19937 rng(12345);
+    uniform_real_distribution<float> coord(0.0f, 1.0f);
+
+    cout << "=== BENCHMARK ===" << endl;
+    for (size_t n = 10000; n <= 10000000; n *= 10)
+    {
+        vector<pts> points;
+        points.reserve(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            points.push_back(pts(coord(rng), coord(rng), i));
+        }
+
+        auto t0 = chrono::steady_clock::now();
+        vector<CoincidentGroup> groups = findCoincidentGroups(points);
+        auto t1 = chrono::steady_clock::now();
+        vector<pts> uniquePoints = removeDuplicates(points);
+        auto t2 = chrono::steady_clock::now();
+
+        cout << "n = " << n
+             << "  findCoincidentGroups: " << chrono::duration<double, milli>(t1 - t0).count() << " ms"
+             << "  removeDuplicates: " << chrono::duration<double, milli>(t2 - t1).count() << " ms"
+             << "  groups: " << groups.size()
+             << "  unique: " << uniquePoints.size() << endl;
+    }
+}
+
+// Command-line numbers must be the whole argument; "0.9x" or "" is rejected.
+bool parseDouble(const string &text, double &value)
+{
+    char *end;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && isfinite(value);
+}
+
+bool parseUnsigned(const string &text, unsigned &value)
+{
+    char *end;
+    unsigned long parsed = strtoul(text.c_str(), &end, 10);
+    if (text.empty() || !isdigit((unsigned char)text[0]) || *end != '\0' || parsed > UINT_MAX)
+        return false;
+    value = parsed;
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
     string filename;
-    if (argc > 1)
+    unsigned threads = 0;
+    // Arguments after an optional "--threads N" start at argv[first].
+    int first = 1;
+    if (argc > 1 && string(argv[1]) == "--threads")
     {
-        filename = argv[1];
+        if (argc < 3 || !parseUnsigned(argv[2], threads) || threads == 0)
+        {
+            cout << "Usage: " << argv[0] << " [--threads N] <filename>, with N >= 1" << endl;
+            return 1;
+        }
+        first = 3;
+    }
+    if (argc > first)
+    {
+        filename = argv[first];
+        if (filename == "--bench")
+        {
+            runBenchmark();
+            return 0;
+        }
+        if (filename == "--lines")
+        {
+            double threshold, confidence = 0.99;
+            unsigned seed = 1;
+            if (argc < first + 3 || !parseDouble(argv[first + 2], threshold) || threshold <= 0 ||
+                (argc > first + 3 && (!parseDouble(argv[first + 3], confidence) || confidence <= 0 || confidence >= 1)) ||
+                (argc > first + 4 && !parseUnsigned(argv[first + 4], seed)))
+            {
+                cout << "Usage: " << argv[0] << " --lines <filename> <k|fraction> [confidence] [seed]" << endl;
+                cout << "k > 0 points (or a fraction below 1), 0 < confidence < 1, seed a non-negative integer" << endl;
+                return 1;
+            }
+            return reportHeavyLines(argv[first + 1], threshold, confidence, seed);
+        }
+        if (filename == "--collinear")
+        {
+            if (argc < first + 2)
+            {
+                cout << "Usage: " << argv[0] << " --collinear <filename>" << endl;
+                return 1;
+            }
+            return streamCollinearVerdict(argv[first + 1]);
+        }
     }
     else
     {
@@ -405,7 +970,7 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    analyzePoints(points);
+    analyzePoints(points, threads);
 
     return 0;
 }
\ No newline at end of file
@@ -3,6 +3,25 @@
 #include <fstream>
 #include <cmath>
 #include <algorithm>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <cctype>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 const double EPS = 1e-6;
@@ -66,31 +85,371 @@ bool doIntersect(const Point &p1, const Point &q1, const Point &p2, const Point
     return false;
 }
 
+struct SweepEdge
+{
+    Point p, q;
+    int id;
+
+    double yAt(double x) const
+    {
+        if (p.x == q.x)
+            return p.y;
+        return p.y + (q.y - p.y) * (x - p.x) / (q.x - p.x);
+    }
+};
+
+// Orders edges by their height at the later of the two left endpoints.
+// Edges that meet there (typically the two edges of a shared vertex) are
+// ordered by direction, then by id, so the status stays a strict order.
+struct SweepStatusLess
+{
+    const vector<SweepEdge> *edges;
+
+    bool operator()(int a, int b) const
+    {
+        const SweepEdge &ea = (*edges)[a];
+        const SweepEdge &eb = (*edges)[b];
+        double x = max(ea.p.x, eb.p.x);
+        double ya = ea.yAt(x), yb = eb.yAt(x);
+        if (abs(ya - yb) > EPS)
+            return ya < yb;
+
+        double turn = crossProduct(ea.q - ea.p, eb.q - eb.p);
+        if (abs(turn) > EPS)
+            return turn > 0;
+        return a < b;
+    }
+};
+
+struct SweepEvent
+{
+    double x, y;
+    bool isInsert;
+    int id;
+
+    bool operator<(const SweepEvent &other) const
+    {
+        if (x != other.x)
+            return x < other.x;
+        if (isInsert != other.isInsert)
+            return isInsert;
+        return y < other.y;
+    }
+};
+
+// Builds the polygon's edges with each one oriented left to right (bottom to
+// top for vertical edges), plus their insert and remove events in sweep order.
+vector<SweepEdge> buildSweepEdges(const vector<Point> &points, vector<SweepEvent> &events)
+{
+    int n = points.size();
+    vector<SweepEdge> edges(n);
+    events.clear();
+    events.reserve(2 * n);
+
+    for (int i = 0; i < n; i++)
+    {
+        Point a = points[i];
+        Point b = points[(i + 1) % n];
+        if (b.x < a.x || (b.x == a.x && b.y < a.y))
+            swap(a, b);
+
+        edges[i].p = a;
+        edges[i].q = b;
+        edges[i].id = i;
+        events.push_back({a.x, a.y, true, i});
+        events.push_back({b.x, b.y, false, i});
+    }
+
+    sort(events.begin(), events.end());
+    return edges;
+}
+
+bool edgesAdjacent(int a, int b, int n)
+{
+    int d = abs(a - b);
+    return d == 1 || d == n - 1;
+}
+
+bool edgesCross(const vector<SweepEdge> &edges, int a, int b)
+{
+    int n = edges.size();
+    if (a == b || edgesAdjacent(a, b, n))
+        return false;
+    return doIntersect(edges[a].p, edges[a].q, edges[b].p, edges[b].q);
+}
+
+typedef set<int, SweepStatusLess> SweepStatus;
+
+// Tests edge `id` against its status neighbours above `up` and below `down`.
+// Edges that pass through the event point are tied in the status and an
+// adjacent edge among them can hide a crossing one, so the walk continues
+// while the neighbours still touch the event point.
+bool crossesNeighbours(const SweepStatus &status, SweepStatus::const_iterator up, SweepStatus::const_iterator down,
+                       const vector<SweepEdge> &edges, const SweepEvent &e)
+{
+    for (auto it = up; it != status.end(); ++it)
+    {
+        if (edgesCross(edges, e.id, *it))
+            return true;
+        if (abs(edges[*it].yAt(e.x) - e.y) > EPS)
+            break;
+    }
+    for (auto it = down; it != status.begin();)
+    {
+        --it;
+        if (edgesCross(edges, e.id, *it))
+            return true;
+        if (abs(edges[*it].yAt(e.x) - e.y) > EPS)
+            break;
+    }
+    return false;
+}
+
+// Shamos-Hoey: sweep the edge endpoints left to right and only test edges
+// that become neighbours in the status structure, stopping at the first
+// intersection between non-adjacent edges. O(n log n).
 bool isSimplePolygon(const vector<Point> &points)
 {
     int n = points.size();
     if (n < 3)
         return false;
 
-    for (int i = 0; i < n; i++)
+    vector<SweepEvent> events;
+    vector<SweepEdge> edges = buildSweepEdges(points, events);
+
+    SweepStatusLess less;
+    less.edges = &edges;
+    SweepStatus status(less);
+    vector<SweepStatus::iterator> where(n, status.end());
+
+    for (const SweepEvent &e : events)
     {
-        for (int j = i + 2; j < n; j++)
+        if (e.isInsert)
+        {
+            auto next = status.lower_bound(e.id);
+            if (crossesNeighbours(status, next, next, edges, e))
+                return false;
+            where[e.id] = status.insert(next, e.id);
+        }
+        else
         {
-            if (i == 0 && j == n - 1)
-                continue;
+            auto it = where[e.id];
+            auto next = std::next(it);
+            if (crossesNeighbours(status, next, it, edges, e))
+                return false;
+            if (it != status.begin() && next != status.end() && edgesCross(edges, *prev(it), *next))
+                return false;
+            status.erase(it);
+        }
+    }
+    return true;
+}
 
-            Point p1 = points[i];
-            Point q1 = points[(i + 1) % n];
-            Point p2 = points[j];
-            Point q2 = points[(j + 1) % n];
+struct SweepPointLess
+{
+    bool operator()(const Point &a, const Point &b) const
+    {
+        if (a.x != b.x)
+            return a.x < b.x;
+        return a.y < b.y;
+    }
+};
 
-            if (doIntersect(p1, q1, p2, q2))
+// Signed distance of p from the line through e; positive means above (left of)
+// the left-to-right oriented edge.
+double sideOf(const Point &p, const SweepEdge &e)
+{
+    Point d = e.q - e.p;
+    return crossProduct(d, p - e.p) / sqrt(d.x * d.x + d.y * d.y);
+}
+
+// Status order for the reporting sweep. Every comparison the set makes
+// involves an edge through the current event point, so edges are ordered by
+// which side of each other the event point lies on. Edges that both pass
+// through it are ordered by direction, which is their order just after it.
+struct ReportStatusLess
+{
+    typedef void is_transparent;
+
+    const vector<SweepEdge> *edges;
+    const Point *sweep;
+
+    bool operator()(int a, int b) const
+    {
+        const SweepEdge &ea = (*edges)[a];
+        const SweepEdge &eb = (*edges)[b];
+        double da = sideOf(*sweep, ea), db = sideOf(*sweep, eb);
+        bool throughA = abs(da) <= EPS, throughB = abs(db) <= EPS;
+
+        if (throughA && throughB)
+        {
+            double turn = crossProduct(ea.q - ea.p, eb.q - eb.p);
+            if (abs(turn) > EPS)
+                return turn > 0;
+            return a < b;
+        }
+        if (throughA)
+            return db < 0;
+        if (throughB)
+            return da > 0;
+        return ea.yAt(sweep->x) < eb.yAt(sweep->x);
+    }
+
+    bool operator()(int a, const Point &p) const
+    {
+        return sideOf(p, (*edges)[a]) > EPS;
+    }
+
+    bool operator()(const Point &p, int a) const
+    {
+        return sideOf(p, (*edges)[a]) < -EPS;
+    }
+};
+
+bool intersectionPoint(const SweepEdge &a, const SweepEdge &b, Point &out)
+{
+    Point r = a.q - a.p;
+    Point s = b.q - b.p;
+    double denom = crossProduct(r, s);
+    if (abs(denom) < EPS * EPS)
+        return false;
+
+    double t = crossProduct(b.p - a.p, s) / denom;
+    double u = crossProduct(b.p - a.p, r) / denom;
+    if (t < -EPS || t > 1 + EPS || u < -EPS || u > 1 + EPS)
+        return false;
+
+    out = Point(a.p.x + t * r.x, a.p.y + t * r.y);
+    return true;
+}
+
+// Bentley-Ottmann sweep that writes every pair of non-adjacent edges meeting
+// at a point to `out` as soon as the point is processed, so nothing but the
+// sweep state is kept in memory. Collinear overlaps are reported at the
+// endpoints of the overlap. Edge i joins vertex i to vertex i + 1.
+// Returns the number of reported pairs. O((n + k) log n).
+size_t reportSelfIntersections(const vector<Point> &points, ostream &out)
+{
+    int n = points.size();
+    if (n < 3)
+        return 0;
+
+    vector<SweepEvent> endpoints;
+    vector<SweepEdge> edges = buildSweepEdges(points, endpoints);
+
+    // Events are ordered exactly; points within EPS of a queued event are
+    // merged into it instead of being queued again.
+    typedef map<Point, vector<int>, SweepPointLess> EventQueue;
+    EventQueue queue;
+    auto enqueue = [&](const Point &p) -> EventQueue::iterator
+    {
+        auto it = queue.lower_bound(p);
+        if (it != queue.end() && it->first == p)
+            return it;
+        if (it != queue.begin() && prev(it)->first == p)
+            return prev(it);
+        return queue.insert(it, make_pair(p, vector<int>()));
+    };
+
+    for (const SweepEvent &e : endpoints)
+    {
+        auto it = enqueue(Point(e.x, e.y));
+        if (e.isInsert)
+            it->second.push_back(e.id);
+    }
+
+    Point sweep;
+    ReportStatusLess less;
+    less.edges = &edges;
+    less.sweep = &sweep;
+    set<int, ReportStatusLess> status(less);
+    vector<set<int, ReportStatusLess>::iterator> where(n, status.end());
+
+    auto schedule = [&](int a, int b)
+    {
+        Point x;
+        if (!intersectionPoint(edges[a], edges[b], x))
+            return;
+        if (SweepPointLess()(sweep, x) && !(x == sweep))
+            enqueue(x);
+    };
+
+    size_t reported = 0;
+    while (!queue.empty())
+    {
+        sweep = queue.begin()->first;
+        vector<int> starts = queue.begin()->second;
+        queue.erase(queue.begin());
+
+        auto first = status.lower_bound(sweep);
+        auto last = first;
+        vector<int> through;
+        while (last != status.end() && !less(sweep, *last))
+        {
+            through.push_back(*last);
+            ++last;
+        }
+
+        vector<int> meeting = starts;
+        meeting.insert(meeting.end(), through.begin(), through.end());
+        sort(meeting.begin(), meeting.end());
+        for (size_t i = 0; i < meeting.size(); i++)
+        {
+            for (size_t j = i + 1; j < meeting.size(); j++)
             {
-                return false;
+                if (edgesAdjacent(meeting[i], meeting[j], n))
+                    continue;
+                out << "Intersection at (" << sweep.x << ", " << sweep.y << "): edges "
+                    << meeting[i] << " and " << meeting[j] << "\n";
+                reported++;
             }
         }
+
+        status.erase(first, last);
+
+        vector<int> inserted = starts;
+        for (int id : through)
+        {
+            if (!(edges[id].q == sweep))
+                inserted.push_back(id);
+        }
+        for (int id : inserted)
+        {
+            where[id] = status.insert(id).first;
+        }
+
+        if (inserted.empty())
+        {
+            auto above = status.lower_bound(sweep);
+            if (above != status.end() && above != status.begin())
+                schedule(*prev(above), *above);
+            continue;
+        }
+
+        int lowest = inserted[0], highest = inserted[0];
+        for (int id : inserted)
+        {
+            if (less(id, lowest))
+                lowest = id;
+            if (less(highest, id))
+                highest = id;
+        }
+        if (where[lowest] != status.begin())
+            schedule(*prev(where[lowest]), lowest);
+        auto next = std::next(where[highest]);
+        if (next != status.end())
+            schedule(highest, *next);
     }
-    return true;
+
+    return reported;
+}
+
+inline void recordTurn(double x1, double y1, double x2, double y2, double x3, double y3,
+                       bool &hasPositive, bool &hasNegative)
+{
+    double cross = (x2 - x1) * (y3 - y2) - (y2 - y1) * (x3 - x2);
+    hasPositive |= cross > EPS;
+    hasNegative |= cross < -EPS;
 }
 
 bool isConvexPolygon(const vector<Point> &points)
@@ -101,29 +460,130 @@ bool isConvexPolygon(const vector<Point> &points)
 
     bool hasPositive = false, hasNegative = false;
 
-    for (int i = 0; i < n; i++)
+    for (int i = 0; i + 2 < n; i++)
     {
-        Point p1 = points[i];
-        Point p2 = points[(i + 1) % n];
-        Point p3 = points[(i + 2) % n];
+        const Point &p1 = points[i];
+        const Point &p2 = points[i + 1];
+        const Point &p3 = points[i + 2];
+        recordTurn(p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, hasPositive, hasNegative);
+
+        if (hasPositive && hasNegative)
+            return false;
+    }
+
+    const Point &a = points[n - 2], &b = points[n - 1], &c = points[0], &d = points[1];
+    recordTurn(a.x, a.y, b.x, b.y, c.x, c.y, hasPositive, hasNegative);
+    recordTurn(b.x, b.y, c.x, c.y, d.x, d.y, hasPositive, hasNegative);
 
-        double cross = crossProduct(p2 - p1, p3 - p2);
+    return !(hasPositive && hasNegative);
+}
+
+// Same test over separate x[] and y[] arrays. The turns are computed four at a
+// time with AVX2 when the file is built with -mavx2, otherwise by a plain loop
+// the compiler can vectorize. Sign flags are checked once per block so the
+// scan still stops early on clearly concave input.
+bool isConvexPolygonSoA(const double *xs, const double *ys, size_t n)
+{
+    if (n < 3)
+        return false;
 
-        if (abs(cross) > EPS)
+    const size_t CHECK_BLOCK = 256;
+    bool hasPositive = false, hasNegative = false;
+    size_t i = 0;
+
+#ifdef __AVX2__
+    const __m256d eps = _mm256_set1_pd(EPS), negEps = _mm256_set1_pd(-EPS);
+    __m256d pos = _mm256_setzero_pd(), neg = _mm256_setzero_pd();
+    for (size_t block = 0; i + 6 <= n; i += 4)
+    {
+        __m256d x1 = _mm256_loadu_pd(xs + i), x2 = _mm256_loadu_pd(xs + i + 1), x3 = _mm256_loadu_pd(xs + i + 2);
+        __m256d y1 = _mm256_loadu_pd(ys + i), y2 = _mm256_loadu_pd(ys + i + 1), y3 = _mm256_loadu_pd(ys + i + 2);
+        __m256d cross = _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(x2, x1), _mm256_sub_pd(y3, y2)),
+                                      _mm256_mul_pd(_mm256_sub_pd(y2, y1), _mm256_sub_pd(x3, x2)));
+        pos = _mm256_or_pd(pos, _mm256_cmp_pd(cross, eps, _CMP_GT_OQ));
+        neg = _mm256_or_pd(neg, _mm256_cmp_pd(cross, negEps, _CMP_LT_OQ));
+
+        if (++block == CHECK_BLOCK / 4)
         {
-            if (cross > 0)
-                hasPositive = true;
-            if (cross < 0)
-                hasNegative = true;
+            block = 0;
+            if (_mm256_movemask_pd(pos) && _mm256_movemask_pd(neg))
+                return false;
         }
+    }
+    hasPositive = _mm256_movemask_pd(pos) != 0;
+    hasNegative = _mm256_movemask_pd(neg) != 0;
+#endif
 
+    while (i + 2 < n)
+    {
+        size_t end = min(n - 2, i + CHECK_BLOCK);
+        for (; i < end; i++)
+            recordTurn(xs[i], ys[i], xs[i + 1], ys[i + 1], xs[i + 2], ys[i + 2], hasPositive, hasNegative);
         if (hasPositive && hasNegative)
             return false;
     }
 
-    return true;
+    recordTurn(xs[n - 2], ys[n - 2], xs[n - 1], ys[n - 1], xs[0], ys[0], hasPositive, hasNegative);
+    recordTurn(xs[n - 1], ys[n - 1], xs[0], ys[0], xs[1], ys[1], hasPositive, hasNegative);
+
+    return !(hasPositive && hasNegative);
 }
 
+// Read-only view of a polygon stored as raw native doubles: n x coordinates
+// followed by n y coordinates (e.g. numpy.concatenate([xs, ys]).tofile()).
+// The file is mapped, not copied, and handed straight to isConvexPolygonSoA.
+struct MappedPolygon
+{
+    const double *xs = nullptr;
+    const double *ys = nullptr;
+    size_t n = 0;
+    void *base = nullptr;
+    size_t bytes = 0;
+
+    // The destructor unmaps the file, so a copy would unmap it twice.
+    MappedPolygon() = default;
+    MappedPolygon(const MappedPolygon &) = delete;
+    MappedPolygon &operator=(const MappedPolygon &) = delete;
+
+    bool open(const string &filename)
+    {
+#ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0 || st.st_size % (2 * sizeof(double)) != 0)
+        {
+            close(fd);
+            return false;
+        }
+        bytes = st.st_size;
+        base = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+        {
+            base = nullptr;
+            return false;
+        }
+        n = bytes / (2 * sizeof(double));
+        xs = static_cast<const double *>(base);
+        ys = xs + n;
+        return true;
+#else
+        (void)filename;
+        return false;
+#endif
+    }
+
+    ~MappedPolygon()
+    {
+#ifndef _WIN32
+        if (base)
+            munmap(base, bytes);
+#endif
+    }
+};
+
 vector<Point> removeDuplicates(const vector<Point> &points)
 {
     vector<Point> result;
@@ -143,10 +603,493 @@ vector<Point> removeDuplicates(const vector<Point> &points)
     return result;
 }
 
+// Keeps the simple / not-simple verdict of a polygon up to date while its
+// vertices are moved, inserted and erased. Edges live in a hashed uniform
+// grid, and the number of intersecting non-adjacent edge pairs is kept as a
+// running count, so an edit only tests the edges near the two or three edges
+// it replaces. Vertex handles stay valid across edits; edge v runs from
+// vertex v to its successor.
+class IncrementalSimplicity
+{
+private:
+    vector<Point> pos;
+    vector<int> next, prev;
+    vector<bool> alive;
+    vector<int> freeIds;
+    int head = -1;
+    size_t count = 0;
+
+    // Cells are about one average edge long. Edits that move the average
+    // more than GRID_DRIFT times away from cellSize re-grid the polygon.
+    static constexpr double GRID_DRIFT = 4;
+    double cellSize = 1;
+    double gridLength = 0;
+    size_t gridEdges = 0;
+    unordered_map<long long, vector<int>> grid;
+    vector<unsigned> seen;
+    unsigned stamp = 0;
+    size_t badPairs = 0;
+
+    long long cellOf(double v) const
+    {
+        return (long long)floor(v / cellSize);
+    }
+
+    static long long cellKey(long long cx, long long cy)
+    {
+        return (long long)((unsigned long long)cx << 32 ^ ((unsigned long long)cy & 0xffffffffULL));
+    }
+
+    double edgeLength(int e) const
+    {
+        Point d = pos[next[e]] - pos[e];
+        return sqrt(d.x * d.x + d.y * d.y);
+    }
+
+    // Visits the cells edge e passes through, one grid row at a time, so a
+    // long edge costs its length in cells rather than its bounding box.
+    // orientation() calls points within EPS / |e| of the edge collinear, a
+    // horizontal offset of up to EPS / |dy|; each row's column span is
+    // widened by that (and the box by EPS) so near-touching edges still
+    // share a cell.
+    template <class F>
+    void forEachCell(int e, F visit) const
+    {
+        const Point &a = pos[e], &b = pos[next[e]];
+        double minX = min(a.x, b.x) - EPS, maxX = max(a.x, b.x) + EPS;
+        double minY = min(a.y, b.y), maxY = max(a.y, b.y);
+        double dy = b.y - a.y;
+        long long y1 = cellOf(maxY + EPS);
+        for (long long cy = cellOf(minY - EPS); cy <= y1; cy++)
+        {
+            double xlo = minX, xhi = maxX;
+            if (dy != 0)
+            {
+                double slack = 1e-9 * cellSize;
+                double lo = max(minY, min(maxY, cy * cellSize - slack));
+                double hi = min(maxY, max(minY, (cy + 1) * cellSize + slack));
+                double xa = a.x + (lo - a.y) * (b.x - a.x) / dy;
+                double xb = a.x + (hi - a.y) * (b.x - a.x) / dy;
+                double pad = EPS + EPS / abs(dy) + 1e-12 * (abs(xa) + abs(xb) + cellSize);
+                xlo = max(minX, min(xa, xb) - pad);
+                xhi = min(maxX, max(xa, xb) + pad);
+            }
+            long long x1 = cellOf(xhi);
+            for (long long cx = cellOf(xlo); cx <= x1; cx++)
+                visit(cellKey(cx, cy));
+        }
+    }
+
+    bool adjacent(int e, int f) const
+    {
+        return next[e] == f || next[f] == e;
+    }
+
+    // Number of edges currently in the grid that cross edge e.
+    size_t crossings(int e)
+    {
+        if (++stamp == 0)
+        {
+            fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+        seen[e] = stamp;
+
+        size_t found = 0;
+        forEachCell(e, [&](long long key)
+                    {
+            auto it = grid.find(key);
+            if (it == grid.end())
+                return;
+            for (int f : it->second)
+            {
+                if (seen[f] == stamp)
+                    continue;
+                seen[f] = stamp;
+                if (!adjacent(e, f) && doIntersect(pos[e], pos[next[e]], pos[f], pos[next[f]]))
+                    found++;
+            } });
+        return found;
+    }
+
+    void addEdge(int e)
+    {
+        badPairs += crossings(e);
+        forEachCell(e, [&](long long key)
+                    { grid[key].push_back(e); });
+        gridLength += edgeLength(e);
+        gridEdges++;
+    }
+
+    void removeEdge(int e)
+    {
+        forEachCell(e, [&](long long key)
+                    {
+            vector<int> &cell = grid[key];
+            auto it = find(cell.begin(), cell.end(), e);
+            if (it != cell.end())
+            {
+                *it = cell.back();
+                cell.pop_back();
+            }
+            if (cell.empty())
+                grid.erase(key); });
+        badPairs -= crossings(e);
+        gridLength -= edgeLength(e);
+        gridEdges--;
+    }
+
+    // Called by an edit before it adds the edges in pending: if the average
+    // edge length including them has drifted too far from cellSize, the
+    // edges already in the grid are re-listed at the new size. Crossing
+    // counts do not depend on the grid, so badPairs is kept.
+    void regridFor(initializer_list<int> pending)
+    {
+        double length = gridLength;
+        for (int e : pending)
+            length += edgeLength(e);
+        double average = length / (gridEdges + pending.size());
+        if (average <= EPS || (average < GRID_DRIFT * cellSize && average * GRID_DRIFT > cellSize))
+            return;
+
+        cellSize = average;
+        grid.clear();
+        int e = head;
+        do
+        {
+            if (find(pending.begin(), pending.end(), e) == pending.end())
+                forEachCell(e, [&](long long key)
+                            { grid[key].push_back(e); });
+            e = next[e];
+        } while (e != head);
+    }
+
+    int newVertex(const Point &p)
+    {
+        int v;
+        if (!freeIds.empty())
+        {
+            v = freeIds.back();
+            freeIds.pop_back();
+            pos[v] = p;
+            alive[v] = true;
+        }
+        else
+        {
+            v = pos.size();
+            pos.push_back(p);
+            next.push_back(-1);
+            prev.push_back(-1);
+            alive.push_back(true);
+            seen.push_back(0);
+        }
+        return v;
+    }
+
+public:
+    void build(const vector<Point> &polygon)
+    {
+        int n = polygon.size();
+        pos = polygon;
+        next.assign(n, 0);
+        prev.assign(n, 0);
+        alive.assign(n, true);
+        seen.assign(n, 0);
+        freeIds.clear();
+        grid.clear();
+        gridLength = 0;
+        gridEdges = 0;
+        badPairs = 0;
+        count = n;
+        head = n > 0 ? 0 : -1;
+
+        double total = 0;
+        for (int i = 0; i < n; i++)
+        {
+            next[i] = (i + 1) % n;
+            prev[i] = (i + n - 1) % n;
+            Point d = polygon[next[i]] - polygon[i];
+            total += sqrt(d.x * d.x + d.y * d.y);
+        }
+        cellSize = n > 0 && total > EPS ? total / n : 1;
+
+        for (int i = 0; i < n; i++)
+            addEdge(i);
+    }
+
+    bool isSimple() const
+    {
+        return count >= 3 && badPairs == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    void moveVertex(int v, const Point &p)
+    {
+        removeEdge(prev[v]);
+        removeEdge(v);
+        pos[v] = p;
+        regridFor({prev[v], v});
+        addEdge(prev[v]);
+        addEdge(v);
+    }
+
+    // Inserts a vertex between v and its successor and returns its handle.
+    int insertVertexAfter(int v, const Point &p)
+    {
+        removeEdge(v);
+        int u = newVertex(p);
+        next[u] = next[v];
+        prev[u] = v;
+        prev[next[v]] = u;
+        next[v] = u;
+        count++;
+        regridFor({v, u});
+        addEdge(v);
+        addEdge(u);
+        return u;
+    }
+
+    void eraseVertex(int v)
+    {
+        int a = prev[v], b = next[v];
+        removeEdge(a);
+        removeEdge(v);
+        next[a] = b;
+        prev[b] = a;
+        alive[v] = false;
+        freeIds.push_back(v);
+        count--;
+        if (head == v)
+            head = b;
+        regridFor({a});
+        addEdge(a);
+    }
+
+    bool isAlive(int v) const
+    {
+        return v >= 0 && v < (int)alive.size() && alive[v];
+    }
+
+    vector<Point> polygon() const
+    {
+        vector<Point> ring;
+        if (head < 0)
+            return ring;
+        int v = head;
+        do
+        {
+            ring.push_back(pos[v]);
+            v = next[v];
+        } while (v != head);
+        return ring;
+    }
+};
+
+// Applies edits of the form "move v x y", "insert v x y" (after vertex v) and
+// "erase v" to the polygon and prints the verdict after each one.
+int runEdits(const vector<Point> &points, const string &editsFile)
+{
+    ifstream edits(editsFile);
+    if (!edits.is_open())
+    {
+        cout << "Error: Could not open file " << editsFile << endl;
+        return 1;
+    }
+
+    IncrementalSimplicity checker;
+    checker.build(points);
+    cout << "Initial: Is Simple Polygon: " << (checker.isSimple() ? "YES" : "NO") << endl;
+
+    string line;
+    int editNo = 0;
+    while (getline(edits, line))
+    {
+        istringstream iss(line);
+        string op;
+        int v;
+        double x = 0, y = 0;
+        if (!(iss >> op >> v))
+            continue;
+        editNo++;
+
+        if (!checker.isAlive(v) || (op != "erase" && !(iss >> x >> y)) ||
+            (op == "erase" && checker.size() <= 3))
+        {
+            cout << "Edit " << editNo << ": skipped invalid edit: " << line << endl;
+            continue;
+        }
+
+        if (op == "move")
+            checker.moveVertex(v, Point(x, y));
+        else if (op == "insert")
+            cout << "Edit " << editNo << ": inserted vertex " << checker.insertVertexAfter(v, Point(x, y)) << endl;
+        else if (op == "erase")
+            checker.eraseVertex(v);
+        else
+        {
+            cout << "Edit " << editNo << ": unknown operation " << op << endl;
+            continue;
+        }
+
+        cout << "Edit " << editNo << " (" << op << " " << v << "): Is Simple Polygon: "
+             << (checker.isSimple() ? "YES" : "NO") << endl;
+    }
+    return 0;
+}
+
+struct PolygonVerdict
+{
+    size_t pointCount;
+    bool valid;
+    bool simple;
+    bool convex;
+};
+
+PolygonVerdict validatePolygon(const vector<Point> &raw)
+{
+    PolygonVerdict verdict = {0, false, false, false};
+    vector<Point> points = removeDuplicates(raw);
+    verdict.pointCount = points.size();
+    if (points.size() < 3)
+        return verdict;
+
+    verdict.valid = true;
+    verdict.simple = isSimplePolygon(points);
+    verdict.convex = isConvexPolygon(points);
+    return verdict;
+}
+
+// Reads polygons separated by one or more blank lines.
+vector<vector<Point>> readPolygonBatch(ifstream &file)
+{
+    vector<vector<Point>> polygons(1);
+    string line;
+    while (getline(file, line))
+    {
+        istringstream iss(line);
+        double x, y;
+        if (iss >> x >> y)
+        {
+            polygons.back().push_back(Point(x, y));
+        }
+        else if (!polygons.back().empty())
+        {
+            polygons.push_back(vector<Point>());
+        }
+    }
+    if (polygons.back().empty())
+        polygons.pop_back();
+    return polygons;
+}
+
+// Validates every polygon of a multi-polygon file on a pool of workers that
+// claim polygons from a shared counter, then prints one line per polygon in
+// input order. threads == 0 means one per core; more than that, or more
+// than there are blocks of polygons to claim, would only sit idle.
+int runBatch(const string &filename, unsigned threads)
+{
+    ifstream file(filename);
+    if (!file.is_open())
+    {
+        cout << "Error: Could not open file " << filename << endl;
+        return 1;
+    }
+    vector<vector<Point>> polygons = readPolygonBatch(file);
+    file.close();
+
+    const size_t BATCH_BLOCK = 64;
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    if (threads == 0 || threads > cores)
+        threads = cores;
+    threads = min<size_t>(threads, max<size_t>(1, (polygons.size() + BATCH_BLOCK - 1) / BATCH_BLOCK));
+
+    vector<PolygonVerdict> verdicts(polygons.size());
+    atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        size_t begin;
+        while ((begin = next.fetch_add(BATCH_BLOCK)) < polygons.size())
+        {
+            size_t end = min(polygons.size(), begin + BATCH_BLOCK);
+            for (size_t i = begin; i < end; i++)
+                verdicts[i] = validatePolygon(polygons[i]);
+        }
+    };
+
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &th : pool)
+        th.join();
+
+    for (size_t i = 0; i < verdicts.size(); i++)
+    {
+        const PolygonVerdict &v = verdicts[i];
+        cout << "Polygon " << (i + 1) << " (" << v.pointCount << " points): ";
+        if (!v.valid)
+            cout << "ERROR less than 3 points after removing duplicates";
+        else
+            cout << "Simple " << (v.simple ? "YES" : "NO") << ", Convex " << (v.convex ? "YES" : "NO");
+        cout << "\n";
+    }
+    cout << "Validated " << verdicts.size() << " polygon(s)." << endl;
+    return 0;
+}
+
+bool parseUnsigned(const string &text, unsigned &value)
+{
+    char *end;
+    unsigned long parsed = strtoul(text.c_str(), &end, 10);
+    if (text.empty() || !isdigit((unsigned char)text[0]) || *end != '\0' || parsed > UINT_MAX)
+        return false;
+    value = parsed;
+    return true;
+}
+
 int main(int argc, char* argv[])
 {
     string filename;
-    if (argc > 1)
+    bool reportAll = false;
+    if (argc > 2 && string(argv[1]) == "--batch")
+    {
+        unsigned threads = 0;
+        if (argc > 3 && (!parseUnsigned(argv[3], threads) || threads == 0))
+        {
+            cout << "Usage: " << argv[0] << " --batch <filename> [threads], with threads >= 1" << endl;
+            return 1;
+        }
+        return runBatch(argv[2], threads);
+    }
+    if (argc > 2 && string(argv[1]) == "--mapped")
+    {
+        MappedPolygon polygon;
+        if (!polygon.open(argv[2]))
+        {
+            cout << "Error: Could not map file " << argv[2] << endl;
+            return 1;
+        }
+        cout << "Mapped " << polygon.n << " points from file." << endl;
+        bool convex = isConvexPolygonSoA(polygon.xs, polygon.ys, polygon.n);
+        cout << "Is Convex Polygon: " << (convex ? "YES" : "NO") << endl;
+        return 0;
+    }
+    string editsFile;
+    if (argc > 3 && string(argv[1]) == "--edits")
+    {
+        filename = argv[2];
+        editsFile = argv[3];
+    }
+    else if (argc > 2 && string(argv[1]) == "--report")
+    {
+        reportAll = true;
+        filename = argv[2];
+    }
+    else if (argc > 1)
     {
         filename = argv[1];
     }
@@ -189,6 +1132,20 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    if (reportAll)
+    {
+        cout << "\nSelf-intersections:" << endl;
+        size_t count = reportSelfIntersections(points, cout);
+        cout << "\nFound " << count << " self-intersection(s)." << endl;
+        cout << "Is Simple Polygon: " << (count == 0 ? "YES" : "NO") << endl;
+        return 0;
+    }
+
+    if (!editsFile.empty())
+    {
+        return runEdits(points, editsFile);
+    }
+
     bool simple = isSimplePolygon(points);
     cout << "\nIs Simple Polygon: " << (simple ? "YES" : "NO") << endl;
 
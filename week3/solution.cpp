@@ -4,6 +4,12 @@
 #include <string>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <set>
+#include <random>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -15,9 +21,95 @@ struct Point {
     Point(double x, double y) : x(x), y(y) {}
 };
 
+enum PointLocation {
+    INSIDE,
+    OUTSIDE,
+    ON_BOUNDARY
+};
+
+// How a winding number maps to inside: odd, or non-zero. The two agree for
+// a single ring; with holes, NON_ZERO needs them to run against the shell.
+enum FillRule {
+    EVEN_ODD,
+    NON_ZERO
+};
+
 class PointInPolygon {
 private:
+    // Vertices of all rings back to back. Edge i runs from polygon[i] to
+    // polygon[nextVertex[i]], which wraps to the first vertex of its ring.
     vector<Point> polygon;
+    vector<int> nextVertex;
+    FillRule fillRule = EVEN_ODD;
+    // Whether no two edges meet except consecutive ones at their shared
+    // vertex. The trapezoidal map and the batch sweep need this; rings that
+    // cross or overlap are answered by the grid or the crossing loop.
+    bool simpleRings = true;
+
+    // Uniform grid over the polygon's bounding box. Each cell lists the edges
+    // that pass through it (CSR layout) and keeps a reference point that is
+    // not on any of those edges, together with its winding number. Cells
+    // without edges answer directly from it. Polygons whose edges would fill
+    // more than GRID_MAX_ENTRIES_PER_EDGE cell entries each on average are
+    // answered by the trapezoidal map instead.
+    static const int GRID_MIN_EDGES = 32;
+    static const int GRID_MAX_ENTRIES_PER_EDGE = 16;
+    bool useGrid = false;
+    double gridMinX = 0, gridMinY = 0, cellW = 1, cellH = 1;
+    int cols = 0, rows = 0;
+    vector<long long> cellStart;
+    vector<int> cellEdges;
+    vector<Point> cellRef;
+    vector<int> cellWinding;
+    
+    // Edges in SoA form for the batched crossing kernel, which only runs for
+    // polygons of at most SIMD_MAX_EDGES edges; larger ones leave it empty.
+    // The crossing x at height y is ax + (y - ay) * slope, so the hot loop
+    // has no division. Horizontal edges get an empty [crossMinY, crossMaxY)
+    // range and only take part in the boundary test; dir is +1 for upward
+    // edges, -1 down.
+    static const int SIMD_MAX_EDGES = 64;
+    struct EdgeSoA {
+        vector<double> ax, ay, dx, dy, slope, dir;
+        vector<double> minX, maxX, minY, maxY, crossMinY, crossMaxY;
+    } soa;
+    
+    // Trapezoidal map for O(log n) point location, built by randomized
+    // incremental insertion of the edges (expected O(n) trapezoids and
+    // search nodes). Points are ordered lexicographically, which acts as a
+    // symbolic shear: vertical edges and shared x coordinates need no
+    // special cases. Segments are stored left to right; 0 and 1 are the top
+    // and bottom of the bounding box. up is +1 when the edge runs left to
+    // right (so the winding number rises by one crossing it upwards) and -1
+    // otherwise; windAbove is the winding number of the face above it. A
+    // trapezoid's upper/lower neighbours
+    // on a side are the ones touching it above/below its left or right
+    // point, and -1 when that part of the side has zero length.
+    struct MapSegment {
+        Point p, q;
+        int up;
+    };
+    struct Trapezoid {
+        int top, bottom;
+        Point leftp, rightp;
+        int upperLeft, lowerLeft, upperRight, lowerRight;
+        int node;
+    };
+    enum NodeKind { X_NODE, Y_NODE, LEAF };
+    // X nodes send points left/right of p, Y nodes send them above/below a
+    // segment (left/right hold the above/below child); leaves name a
+    // trapezoid.
+    struct MapNode {
+        NodeKind kind;
+        Point p;
+        int index;
+        int left, right;
+    };
+    vector<MapSegment> segments;
+    vector<int> windAbove;
+    vector<Trapezoid> traps;
+    vector<int> freeTraps;
+    vector<MapNode> nodes;
     
     bool isOnEdge(const Point& p, const Point& a, const Point& b) const {
         double cross = (p.y - a.y) * (b.x - a.x) - (p.x - a.x) * (b.y - a.y);
@@ -31,16 +123,25 @@ private:
         return p.x >= minX && p.x <= maxX && p.y >= minY && p.y <= maxY;
     }
     
-    bool isInside(const Point& point) const {
-        int intersections = 0;
+    bool filled(int winding) const {
+        return fillRule == EVEN_ODD ? (winding & 1) != 0 : winding != 0;
+    }
+    
+    // Winding number of all rings around point in one pass over the edges:
+    // crossings to the right count +1 for upward edges and -1 for downward
+    // ones. Stops early with onEdge set when the point is on the boundary.
+    int windingNumber(const Point& point, bool& onEdge) const {
+        int winding = 0;
         int n = polygon.size();
+        onEdge = false;
         
         for (int i = 0; i < n; i++) {
             Point a = polygon[i];
-            Point b = polygon[(i + 1) % n];
+            Point b = polygon[nextVertex[i]];
             
             if (isOnEdge(point, a, b)) {
-                return false;
+                onEdge = true;
+                return 0;
             }
             
             if (fabs(a.y - b.y) < EPS) continue;
@@ -53,28 +154,930 @@ private:
             double intersectionX = a.x + (point.y - a.y) * (b.x - a.x) / (b.y - a.y);
             
             if (intersectionX > point.x) {
-                intersections++;
+                winding += b.y > a.y ? 1 : -1;
+            }
+        }
+        
+        return winding;
+    }
+    
+    bool isInside(const Point& point) const {
+        bool onEdge;
+        int winding = windingNumber(point, onEdge);
+        return !onEdge && filled(winding);
+    }
+    
+    int cellIndex(int cx, int cy) const {
+        return cy * cols + cx;
+    }
+    
+    int clampCol(double x) const {
+        int c = (int)floor((x - gridMinX) / cellW);
+        return max(0, min(cols - 1, c));
+    }
+    
+    int clampRow(double y) const {
+        int r = (int)floor((y - gridMinY) / cellH);
+        return max(0, min(rows - 1, r));
+    }
+    
+    // Calls visit for every cell the segment a-b passes through, one grid row
+    // at a time. isOnEdge accepts points inside the edge's bounding box whose
+    // horizontal offset from the edge is up to EPS / |dy|, so each row's
+    // column span is padded by that much (and by rounding slack) to keep such
+    // points in a cell that lists the edge.
+    template <typename Visit>
+    void forEachCrossedCell(const Point& a, const Point& b, Visit visit) const {
+        double minX = min(a.x, b.x), maxX = max(a.x, b.x);
+        double minY = min(a.y, b.y), maxY = max(a.y, b.y);
+        double dy = b.y - a.y;
+        int r1 = clampRow(maxY);
+        for (int r = clampRow(minY); r <= r1; r++) {
+            double xlo = minX, xhi = maxX;
+            if (dy != 0) {
+                double slack = 1e-9 * cellH;
+                double lo = max(minY, min(maxY, gridMinY + r * cellH - slack));
+                double hi = min(maxY, max(minY, gridMinY + (r + 1) * cellH + slack));
+                double xa = a.x + (lo - a.y) * (b.x - a.x) / dy;
+                double xb = a.x + (hi - a.y) * (b.x - a.x) / dy;
+                double pad = EPS / fabs(dy) + 1e-12 * (fabs(xa) + fabs(xb) + cellW);
+                xlo = max(minX, min(xa, xb) - pad);
+                xhi = min(maxX, max(xa, xb) + pad);
+            }
+            int c1 = clampCol(xhi);
+            for (int c = clampCol(xlo); c <= c1; c++) {
+                visit(cellIndex(c, r));
+            }
+        }
+    }
+    
+    static double side(const Point& a, const Point& b, const Point& p) {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+    
+    // Change in winding number from r to q, using only the edges of one
+    // cell: stepping onto an edge's left side adds one. Vertices exactly on
+    // the line through q and r count as lying on its non-negative side, so a
+    // vertex on the segment is counted once when the boundary passes through
+    // and zero or two times when it only touches.
+    int windingDelta(const Point& q, const Point& r, int cell) const {
+        int delta = 0;
+        for (long long k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+            const Point& a = polygon[cellEdges[k]];
+            const Point& b = polygon[nextVertex[cellEdges[k]]];
+            bool sa = side(q, r, a) >= 0;
+            bool sb = side(q, r, b) >= 0;
+            if (sa == sb) continue;
+            double sq = side(a, b, q);
+            double sr = side(a, b, r);
+            if (sq > 0 && sr < 0) {
+                delta++;
+            } else if (sq < 0 && sr > 0) {
+                delta--;
+            }
+        }
+        return delta;
+    }
+    
+    bool onCellEdge(const Point& p, int cell) const {
+        for (long long k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+            if (isOnEdge(p, polygon[cellEdges[k]], polygon[nextVertex[cellEdges[k]]])) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void buildGrid() {
+        int n = polygon.size();
+        useGrid = n >= GRID_MIN_EDGES;
+        if (!useGrid) return;
+        
+        double maxX = polygon[0].x, maxY = polygon[0].y;
+        gridMinX = polygon[0].x;
+        gridMinY = polygon[0].y;
+        for (const Point& p : polygon) {
+            gridMinX = min(gridMinX, p.x);
+            gridMinY = min(gridMinY, p.y);
+            maxX = max(maxX, p.x);
+            maxY = max(maxY, p.y);
+        }
+        
+        // About four cells per edge, with the cell shape following the box.
+        double w = max(maxX - gridMinX, 1e-12), h = max(maxY - gridMinY, 1e-12);
+        double cell = sqrt(w * h / (4.0 * n));
+        cols = max(1, min(4096, (int)ceil(w / cell)));
+        rows = max(1, min(4096, (int)ceil(h / cell)));
+        cellW = w / cols;
+        cellH = h / rows;
+        
+        int cells = cols * rows;
+        cellStart.assign(cells + 1, 0);
+        // The count gives up as soon as it passes the cap, so a rejected
+        // grid costs no more than an accepted one.
+        const long long cap = (long long)GRID_MAX_ENTRIES_PER_EDGE * n;
+        long long entries = 0;
+        for (int i = 0; i < n; i++) {
+            forEachCrossedCell(polygon[i], polygon[nextVertex[i]], [&](int cell) {
+                cellStart[cell + 1]++;
+                entries++;
+            });
+            if (entries > cap) {
+                useGrid = false;
+                cellStart.clear();
+                return;
+            }
+        }
+        for (int c = 0; c < cells; c++) cellStart[c + 1] += cellStart[c];
+        cellEdges.assign(entries, 0);
+        vector<long long> fill(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < n; i++) {
+            forEachCrossedCell(polygon[i], polygon[nextVertex[i]], [&](int cell) {
+                cellEdges[fill[cell]++] = i;
+            });
+        }
+        
+        cellRef.assign(cells, Point());
+        cellWinding.assign(cells, 0);
+        
+        // Reference points start at the cell centres; the few that land on an
+        // edge are nudged and classified with the full crossing test.
+        vector<vector<pair<double, int>>> rowCrossings(rows);
+        for (int i = 0; i < n; i++) {
+            const Point& a = polygon[i];
+            const Point& b = polygon[nextVertex[i]];
+            if (fabs(a.y - b.y) < EPS) continue;
+            double minY = min(a.y, b.y), maxY = max(a.y, b.y);
+            int r0 = max(0, (int)floor((minY - gridMinY) / cellH - 0.5));
+            for (int r = r0; r < rows; r++) {
+                double y = gridMinY + (r + 0.5) * cellH;
+                if (y >= maxY) break;
+                if (y < minY) continue;
+                rowCrossings[r].push_back(make_pair(a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y), b.y > a.y ? 1 : -1));
+            }
+        }
+        
+        const double nudges[][2] = {{0.5, 0.5}, {0.3183, 0.6180}, {0.7071, 0.2679}, {0.1414, 0.8660}, {0.9, 0.1}};
+        for (int r = 0; r < rows; r++) {
+            vector<pair<double, int>>& xs = rowCrossings[r];
+            sort(xs.begin(), xs.end());
+            size_t passed = 0;
+            int windingRight = 0;
+            for (const auto& x : xs) windingRight += x.second;
+            for (int c = 0; c < cols; c++) {
+                int cell = cellIndex(c, r);
+                Point center(gridMinX + (c + 0.5) * cellW, gridMinY + (r + 0.5) * cellH);
+                while (passed < xs.size() && xs[passed].first <= center.x) {
+                    windingRight -= xs[passed++].second;
+                }
+                
+                bool onEdge = onCellEdge(center, cell);
+                cellRef[cell] = center;
+                cellWinding[cell] = onEdge ? 0 : windingRight;
+                if (!onEdge) continue;
+                
+                for (const auto& f : nudges) {
+                    Point p(gridMinX + (c + f[0]) * cellW, gridMinY + (r + f[1]) * cellH);
+                    if (!onCellEdge(p, cell)) {
+                        bool unused;
+                        cellRef[cell] = p;
+                        cellWinding[cell] = windingNumber(p, unused);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    
+    static bool pointLess(const Point& a, const Point& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+    
+    // Orders edges spanning the sweep line by their x there. Edges meeting at
+    // a shared bottom vertex are ordered by where they go just above it.
+    struct ActiveEdgeLess {
+        typedef void is_transparent;
+        
+        const vector<Point>* polygon;
+        const vector<int>* next;
+        const double* sweepY;
+        
+        ActiveEdgeLess(const vector<Point>& poly, const vector<int>& next, const double& y)
+            : polygon(&poly), next(&next), sweepY(&y) {}
+        
+        // Interpolated from the bottom endpoint so that edges sharing it
+        // compare equal there and fall through to the slope test.
+        double xAt(int e) const {
+            const Point* a = &(*polygon)[e];
+            const Point* b = &(*polygon)[(*next)[e]];
+            if (b->y < a->y) swap(a, b);
+            return a->x + (*sweepY - a->y) * (b->x - a->x) / (b->y - a->y);
+        }
+        
+        double inverseSlope(int e) const {
+            const Point& a = (*polygon)[e];
+            const Point& b = (*polygon)[(*next)[e]];
+            return (b.x - a.x) / (b.y - a.y);
+        }
+        
+        bool operator()(int a, int b) const {
+            double xa = xAt(a), xb = xAt(b);
+            if (xa != xb) return xa < xb;
+            double sa = inverseSlope(a), sb = inverseSlope(b);
+            if (sa != sb) return sa < sb;
+            return a < b;
+        }
+        
+        bool operator()(const Point& q, int e) const {
+            return q.x < xAt(e);
+        }
+        
+        bool operator()(int e, const Point& q) const {
+            return xAt(e) < q.x;
+        }
+    };
+    
+    bool isVertex(const vector<Point>& sortedVertices, const Point& q) const {
+        auto it = lower_bound(sortedVertices.begin(), sortedVertices.end(), Point(q.x - EPS, q.y), pointLess);
+        for (; it != sortedVertices.end() && it->x <= q.x + EPS; ++it) {
+            if (fabs(it->y - q.y) <= EPS) return true;
+        }
+        return false;
+    }
+    
+    template <class Horizontal>
+    bool onHorizontalEdge(const vector<Horizontal>& horizontal, const Point& q) const {
+        auto it = lower_bound(horizontal.begin(), horizontal.end(), q.y - EPS,
+                              [](const Horizontal& h, double y) { return h.y < y; });
+        for (; it != horizontal.end() && it->y <= q.y + EPS; ++it) {
+            if (q.x >= it->minX && q.x <= it->maxX) return true;
+        }
+        return false;
+    }
+    
+    static int sideSign(const Point& a, const Point& b, const Point& p) {
+        double o = side(a, b, p);
+        return o > EPS ? 1 : o < -EPS ? -1 : 0;
+    }
+    
+    static bool inBox(const Point& a, const Point& b, const Point& p) {
+        return p.x >= min(a.x, b.x) && p.x <= max(a.x, b.x) && p.y >= min(a.y, b.y) && p.y <= max(a.y, b.y);
+    }
+    
+    static bool segmentsMeet(const Point& a, const Point& b, const Point& c, const Point& d) {
+        int o1 = sideSign(a, b, c), o2 = sideSign(a, b, d);
+        int o3 = sideSign(c, d, a), o4 = sideSign(c, d, b);
+        if (o1 * o2 < 0 && o3 * o4 < 0) return true;
+        return (o1 == 0 && inBox(a, b, c)) || (o2 == 0 && inBox(a, b, d)) ||
+               (o3 == 0 && inBox(c, d, a)) || (o4 == 0 && inBox(c, d, b));
+    }
+    
+    // Status order for edgesMeet(): height at the later of the two left
+    // endpoints, then direction, then index.
+    struct SweepStatusLess {
+        const vector<Point>* left;
+        const vector<Point>* right;
+        
+        double yAt(int e, double x) const {
+            const Point& p = (*left)[e];
+            const Point& q = (*right)[e];
+            if (p.x == q.x) return p.y;
+            return p.y + (q.y - p.y) * (x - p.x) / (q.x - p.x);
+        }
+        
+        bool operator()(int a, int b) const {
+            double x = max((*left)[a].x, (*left)[b].x);
+            double ya = yAt(a, x), yb = yAt(b, x);
+            if (fabs(ya - yb) > EPS) return ya < yb;
+            const Point& pa = (*left)[a];
+            const Point& qa = (*right)[a];
+            const Point& pb = (*left)[b];
+            const Point& qb = (*right)[b];
+            double turn = (qa.x - pa.x) * (qb.y - pb.y) - (qa.y - pa.y) * (qb.x - pb.x);
+            if (fabs(turn) > EPS) return turn > 0;
+            return a < b;
+        }
+    };
+    
+    // Shamos-Hoey over all rings: sweeps the edges left to right and tests
+    // only edges that become neighbours in the status, stopping at the
+    // first pair that meets other than consecutive edges at their shared
+    // vertex. Edges through the event point tie in the status, so the
+    // neighbour walk goes on while they still touch it. O(n log n).
+    bool edgesMeet() const {
+        int n = polygon.size();
+        vector<Point> left(n), right(n);
+        // (point, edge): edge >= 0 inserts it, ~edge removes it.
+        vector<pair<Point, int>> events;
+        for (int i = 0; i < n; i++) {
+            left[i] = polygon[i];
+            right[i] = polygon[nextVertex[i]];
+            if (pointLess(right[i], left[i])) swap(left[i], right[i]);
+            events.push_back(make_pair(left[i], i));
+            events.push_back(make_pair(right[i], ~i));
+        }
+        sort(events.begin(), events.end(), [](const pair<Point, int>& a, const pair<Point, int>& b) {
+            if (a.first.x != b.first.x) return a.first.x < b.first.x;
+            if ((a.second >= 0) != (b.second >= 0)) return a.second >= 0;
+            return a.first.y < b.first.y;
+        });
+        
+        SweepStatusLess less = {&left, &right};
+        typedef set<int, SweepStatusLess> Status;
+        Status status(less);
+        vector<Status::iterator> where(n, status.end());
+        auto meet = [&](int a, int b) {
+            if (a == b || nextVertex[a] == b || nextVertex[b] == a) return false;
+            return segmentsMeet(left[a], right[a], left[b], right[b]);
+        };
+        auto meetsNeighbours = [&](int e, const Point& at, Status::iterator up, Status::iterator down) {
+            for (auto it = up; it != status.end(); ++it) {
+                if (meet(e, *it)) return true;
+                if (fabs(less.yAt(*it, at.x) - at.y) > EPS) break;
+            }
+            for (auto it = down; it != status.begin();) {
+                --it;
+                if (meet(e, *it)) return true;
+                if (fabs(less.yAt(*it, at.x) - at.y) > EPS) break;
+            }
+            return false;
+        };
+        
+        for (const auto& event : events) {
+            if (event.second >= 0) {
+                int e = event.second;
+                auto next = status.lower_bound(e);
+                if (meetsNeighbours(e, event.first, next, next)) return true;
+                where[e] = status.insert(next, e);
+            } else {
+                int e = ~event.second;
+                auto it = where[e];
+                auto next = std::next(it);
+                if (meetsNeighbours(e, event.first, next, it)) return true;
+                if (it != status.begin() && next != status.end() && meet(*prev(it), *next)) return true;
+                status.erase(it);
+            }
+        }
+        return false;
+    }
+    
+    void buildSoA() {
+        int n = polygon.size();
+        EdgeSoA s;
+        if (n > SIMD_MAX_EDGES) {
+            soa = s;
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            const Point& a = polygon[i];
+            const Point& b = polygon[nextVertex[i]];
+            bool horizontal = fabs(a.y - b.y) < EPS;
+            s.ax.push_back(a.x);
+            s.ay.push_back(a.y);
+            s.dx.push_back(b.x - a.x);
+            s.dy.push_back(b.y - a.y);
+            s.slope.push_back(horizontal ? 0 : (b.x - a.x) / (b.y - a.y));
+            s.dir.push_back(horizontal ? 0 : b.y > a.y ? 1 : -1);
+            s.minX.push_back(min(a.x, b.x));
+            s.maxX.push_back(max(a.x, b.x));
+            s.minY.push_back(min(a.y, b.y));
+            s.maxY.push_back(max(a.y, b.y));
+            s.crossMinY.push_back(horizontal ? HUGE_VAL : min(a.y, b.y));
+            s.crossMaxY.push_back(horizontal ? -HUGE_VAL : max(a.y, b.y));
+        }
+        soa = s;
+    }
+    
+    // Crossing-number test for up to four queries at once. Each edge is
+    // broadcast against the queries; the on-boundary test is accumulated as
+    // a lane mask and the winding number as a lane sum.
+    void insideBlock(const Point* q, size_t count, bool* out) const {
+        size_t n = soa.ax.size();
+#ifdef __AVX2__
+        double qxs[4], qys[4];
+        for (size_t k = 0; k < 4; k++) {
+            const Point& p = q[min(k, count - 1)];
+            qxs[k] = p.x;
+            qys[k] = p.y;
+        }
+        const __m256d qx = _mm256_loadu_pd(qxs), qy = _mm256_loadu_pd(qys);
+        const __m256d eps = _mm256_set1_pd(EPS), negEps = _mm256_set1_pd(-EPS);
+        __m256d winding = _mm256_setzero_pd(), onEdge = _mm256_setzero_pd();
+        for (size_t i = 0; i < n; i++) {
+            __m256d ax = _mm256_set1_pd(soa.ax[i]), ay = _mm256_set1_pd(soa.ay[i]);
+            __m256d relX = _mm256_sub_pd(qx, ax), relY = _mm256_sub_pd(qy, ay);
+            __m256d cross = _mm256_sub_pd(_mm256_mul_pd(relY, _mm256_set1_pd(soa.dx[i])),
+                                          _mm256_mul_pd(relX, _mm256_set1_pd(soa.dy[i])));
+            __m256d on = _mm256_and_pd(_mm256_cmp_pd(cross, eps, _CMP_LE_OQ), _mm256_cmp_pd(cross, negEps, _CMP_GE_OQ));
+            on = _mm256_and_pd(on, _mm256_cmp_pd(qx, _mm256_set1_pd(soa.minX[i]), _CMP_GE_OQ));
+            on = _mm256_and_pd(on, _mm256_cmp_pd(qx, _mm256_set1_pd(soa.maxX[i]), _CMP_LE_OQ));
+            on = _mm256_and_pd(on, _mm256_cmp_pd(qy, _mm256_set1_pd(soa.minY[i]), _CMP_GE_OQ));
+            on = _mm256_and_pd(on, _mm256_cmp_pd(qy, _mm256_set1_pd(soa.maxY[i]), _CMP_LE_OQ));
+            onEdge = _mm256_or_pd(onEdge, on);
+            
+            __m256d ix = _mm256_add_pd(ax, _mm256_mul_pd(relY, _mm256_set1_pd(soa.slope[i])));
+            __m256d hit = _mm256_and_pd(_mm256_cmp_pd(qy, _mm256_set1_pd(soa.crossMinY[i]), _CMP_GE_OQ),
+                                        _mm256_cmp_pd(qy, _mm256_set1_pd(soa.crossMaxY[i]), _CMP_LT_OQ));
+            hit = _mm256_and_pd(hit, _mm256_cmp_pd(ix, qx, _CMP_GT_OQ));
+            winding = _mm256_add_pd(winding, _mm256_and_pd(hit, _mm256_set1_pd(soa.dir[i])));
+        }
+        double windings[4];
+        _mm256_storeu_pd(windings, winding);
+        int boundary = _mm256_movemask_pd(onEdge);
+        for (size_t k = 0; k < count; k++) {
+            out[k] = !((boundary >> k) & 1) && filled((int)windings[k]);
+        }
+#else
+        for (size_t k = 0; k < count; k++) {
+            double qx = q[k].x, qy = q[k].y;
+            int winding = 0;
+            bool onEdge = false;
+            for (size_t i = 0; i < n; i++) {
+                double relX = qx - soa.ax[i], relY = qy - soa.ay[i];
+                double cross = relY * soa.dx[i] - relX * soa.dy[i];
+                onEdge |= cross <= EPS && cross >= -EPS && qx >= soa.minX[i] && qx <= soa.maxX[i] &&
+                          qy >= soa.minY[i] && qy <= soa.maxY[i];
+                double ix = soa.ax[i] + relY * soa.slope[i];
+                if (qy >= soa.crossMinY[i] && qy < soa.crossMaxY[i] && ix > qx) {
+                    winding += (int)soa.dir[i];
+                }
+            }
+            out[k] = !onEdge && filled(winding);
+        }
+#endif
+    }
+    
+    static bool samePoint(const Point& a, const Point& b) {
+        return a.x == b.x && a.y == b.y;
+    }
+    
+    int addTrapezoid(int top, int bottom, const Point& leftp, const Point& rightp) {
+        Trapezoid t = {top, bottom, leftp, rightp, -1, -1, -1, -1, -1};
+        if (!freeTraps.empty()) {
+            int slot = freeTraps.back();
+            freeTraps.pop_back();
+            traps[slot] = t;
+            return slot;
+        }
+        traps.push_back(t);
+        return traps.size() - 1;
+    }
+    
+    int addNode(NodeKind kind, const Point& p, int index, int left, int right) {
+        nodes.push_back({kind, p, index, left, right});
+        return nodes.size() - 1;
+    }
+    
+    int leafOf(int t) {
+        if (traps[t].node < 0) {
+            traps[t].node = addNode(LEAF, Point(), t, -1, -1);
+        }
+        return traps[t].node;
+    }
+    
+    void relink(int t, int from, int to) {
+        if (t < 0) return;
+        Trapezoid& x = traps[t];
+        if (x.upperLeft == from) x.upperLeft = to;
+        if (x.lowerLeft == from) x.lowerLeft = to;
+        if (x.upperRight == from) x.upperRight = to;
+        if (x.lowerRight == from) x.lowerRight = to;
+    }
+    
+    // Trapezoid containing the left endpoint of s. An endpoint shared with
+    // an existing segment is resolved by where s goes from there.
+    int findStart(const MapSegment& s) const {
+        int v = 0;
+        while (nodes[v].kind != LEAF) {
+            const MapNode& node = nodes[v];
+            if (node.kind == X_NODE) {
+                v = pointLess(s.p, node.p) ? node.left : node.right;
+            } else {
+                const MapSegment& t = segments[node.index];
+                double o = side(t.p, t.q, s.p);
+                if (o == 0) o = side(t.p, t.q, s.q);
+                v = o > 0 ? node.left : node.right;
+            }
+        }
+        return nodes[v].index;
+    }
+    
+    // Splits the trapezoids crossed by segment si into the parts above and
+    // below it, merging parts that are no longer separated by a vertex, and
+    // turns the old leaves into search nodes.
+    void insertSegment(int si) {
+        const MapSegment s = segments[si];
+        vector<int> crossed(1, findStart(s));
+        while (pointLess(traps[crossed.back()].rightp, s.q)) {
+            const Trapezoid& t = traps[crossed.back()];
+            int next = side(s.p, s.q, t.rightp) > 0 ? t.lowerRight : t.upperRight;
+            // Only reachable when the edges cross; stop rather than walk off.
+            if (next < 0) break;
+            crossed.push_back(next);
+        }
+        
+        int k = crossed.size();
+        vector<Trapezoid> old(k);
+        for (int i = 0; i < k; i++) old[i] = traps[crossed[i]];
+        
+        int left = -1, right = -1;
+        if (!samePoint(s.p, old[0].leftp)) {
+            left = addTrapezoid(old[0].top, old[0].bottom, old[0].leftp, s.p);
+        }
+        if (!samePoint(s.q, old[k - 1].rightp)) {
+            right = addTrapezoid(old[k - 1].top, old[k - 1].bottom, s.q, old[k - 1].rightp);
+        }
+        
+        vector<int> above(k), below(k);
+        above[0] = addTrapezoid(old[0].top, si, s.p, s.q);
+        below[0] = addTrapezoid(si, old[0].bottom, s.p, s.q);
+        for (int i = 1; i < k; i++) {
+            const Point& r = old[i].leftp;
+            if (side(s.p, s.q, r) > 0) {
+                int prevAbove = above[i - 1];
+                traps[prevAbove].rightp = r;
+                above[i] = addTrapezoid(old[i].top, si, r, s.q);
+                below[i] = below[i - 1];
+                traps[prevAbove].upperRight = old[i - 1].upperRight;
+                traps[prevAbove].lowerRight = above[i];
+                traps[above[i]].upperLeft = old[i].upperLeft;
+                traps[above[i]].lowerLeft = prevAbove;
+                relink(old[i - 1].upperRight, crossed[i - 1], prevAbove);
+                relink(old[i].upperLeft, crossed[i], above[i]);
+            } else {
+                int prevBelow = below[i - 1];
+                traps[prevBelow].rightp = r;
+                below[i] = addTrapezoid(si, old[i].bottom, r, s.q);
+                above[i] = above[i - 1];
+                traps[prevBelow].lowerRight = old[i - 1].lowerRight;
+                traps[prevBelow].upperRight = below[i];
+                traps[below[i]].lowerLeft = old[i].lowerLeft;
+                traps[below[i]].upperLeft = prevBelow;
+                relink(old[i - 1].lowerRight, crossed[i - 1], prevBelow);
+                relink(old[i].lowerLeft, crossed[i], below[i]);
             }
         }
         
-        return (intersections % 2) == 1;
+        if (left >= 0) {
+            traps[left].upperLeft = old[0].upperLeft;
+            traps[left].lowerLeft = old[0].lowerLeft;
+            traps[left].upperRight = above[0];
+            traps[left].lowerRight = below[0];
+            relink(old[0].upperLeft, crossed[0], left);
+            relink(old[0].lowerLeft, crossed[0], left);
+            traps[above[0]].upperLeft = left;
+            traps[below[0]].lowerLeft = left;
+        } else {
+            traps[above[0]].upperLeft = old[0].upperLeft;
+            traps[below[0]].lowerLeft = old[0].lowerLeft;
+            relink(old[0].upperLeft, crossed[0], above[0]);
+            relink(old[0].lowerLeft, crossed[0], below[0]);
+        }
+        
+        int lastAbove = above[k - 1], lastBelow = below[k - 1];
+        if (right >= 0) {
+            traps[right].upperLeft = lastAbove;
+            traps[right].lowerLeft = lastBelow;
+            traps[right].upperRight = old[k - 1].upperRight;
+            traps[right].lowerRight = old[k - 1].lowerRight;
+            relink(old[k - 1].upperRight, crossed[k - 1], right);
+            relink(old[k - 1].lowerRight, crossed[k - 1], right);
+            traps[lastAbove].upperRight = right;
+            traps[lastBelow].lowerRight = right;
+        } else {
+            traps[lastAbove].upperRight = old[k - 1].upperRight;
+            traps[lastBelow].lowerRight = old[k - 1].lowerRight;
+            relink(old[k - 1].upperRight, crossed[k - 1], lastAbove);
+            relink(old[k - 1].lowerRight, crossed[k - 1], lastBelow);
+        }
+        
+        // The old leaves are rewritten in place so every parent that pointed
+        // at them now reaches the new subtree.
+        for (int i = 0; i < k; i++) {
+            int up = leafOf(above[i]), down = leafOf(below[i]);
+            MapNode sub = {Y_NODE, Point(), si, up, down};
+            if (i == k - 1 && right >= 0) {
+                int y = addNode(sub.kind, sub.p, sub.index, sub.left, sub.right);
+                sub = {X_NODE, s.q, -1, y, leafOf(right)};
+            }
+            if (i == 0 && left >= 0) {
+                int inner = addNode(sub.kind, sub.p, sub.index, sub.left, sub.right);
+                sub = {X_NODE, s.p, -1, leafOf(left), inner};
+            }
+            nodes[old[i].node] = sub;
+        }
+        
+        // Slots are recycled only by the next insertion, so nothing above
+        // confused an old trapezoid with a new one in the same slot.
+        freeTraps.insert(freeTraps.end(), crossed.begin(), crossed.end());
+    }
+    
+    void buildTrapezoidMap() {
+        int n = polygon.size();
+        segments.clear();
+        traps.clear();
+        freeTraps.clear();
+        nodes.clear();
+        
+        double minX = polygon[0].x, minY = polygon[0].y, maxX = minX, maxY = minY;
+        for (const Point& p : polygon) {
+            minX = min(minX, p.x);
+            minY = min(minY, p.y);
+            maxX = max(maxX, p.x);
+            maxY = max(maxY, p.y);
+        }
+        
+        Point lo(minX - 1, minY - 1), hi(maxX + 1, maxY + 1);
+        segments.push_back({Point(lo.x, hi.y), hi, 0});
+        segments.push_back({lo, Point(hi.x, lo.y), 0});
+        leafOf(addTrapezoid(0, 1, lo, hi));
+        
+        for (int i = 0; i < n; i++) {
+            const Point& a = polygon[i];
+            const Point& b = polygon[nextVertex[i]];
+            if (samePoint(a, b)) continue;
+            bool forward = pointLess(a, b);
+            segments.push_back({forward ? a : b, forward ? b : a, forward ? 1 : -1});
+        }
+        
+        // A fixed seed keeps the structure (and its cost) reproducible.
+        vector<int> order;
+        for (int i = 2; i < (int)segments.size(); i++) order.push_back(i);
+        shuffle(order.begin(), order.end(), mt19937(12345));
+        for (int si : order) insertSegment(si);
+        
+        // The face above a segment is the face below the top of the
+        // trapezoid over its midpoint; resolve those chains from the
+        // bounding box (winding 0) downwards.
+        int m = segments.size();
+        vector<int> topOf(m, 0);
+        for (int si = 2; si < m; si++) {
+            topOf[si] = traps[trapezoidAbove(si)].top;
+        }
+        windAbove.assign(m, 0);
+        vector<char> done(m, 0);
+        done[0] = done[1] = 1;
+        vector<int> chain;
+        for (int si = 2; si < m; si++) {
+            for (int t = si; !done[t]; t = topOf[t]) {
+                chain.push_back(t);
+                done[t] = 1;
+            }
+            while (!chain.empty()) {
+                int t = chain.back(), top = topOf[t];
+                chain.pop_back();
+                windAbove[t] = (top == 0 ? 0 : windAbove[top] - segments[top].up);
+            }
+        }
+    }
+    
+    // Trapezoid lying directly above the midpoint of segment si.
+    int trapezoidAbove(int si) const {
+        const MapSegment& s = segments[si];
+        Point mid((s.p.x + s.q.x) / 2, (s.p.y + s.q.y) / 2);
+        int v = 0;
+        while (nodes[v].kind != LEAF) {
+            const MapNode& node = nodes[v];
+            if (node.kind == X_NODE) {
+                v = pointLess(mid, node.p) ? node.left : node.right;
+            } else {
+                const MapSegment& t = segments[node.index];
+                v = node.index == si || side(t.p, t.q, mid) > 0 ? node.left : node.right;
+            }
+        }
+        return nodes[v].index;
+    }
+    
+    // Walks the map's search structure. Boundary points are caught by the
+    // X/Y node on the path whose vertex or edge they lie on.
+    PointLocation locateInMap(const Point& point) const {
+        int v = 0;
+        while (nodes[v].kind != LEAF) {
+            const MapNode& node = nodes[v];
+            if (node.kind == X_NODE) {
+                if (samePoint(point, node.p)) return ON_BOUNDARY;
+                v = pointLess(point, node.p) ? node.left : node.right;
+            } else {
+                const MapSegment& s = segments[node.index];
+                double o = side(s.p, s.q, point);
+                if (fabs(o) <= EPS) return ON_BOUNDARY;
+                v = o > 0 ? node.left : node.right;
+            }
+        }
+        const Trapezoid& t = traps[nodes[v].index];
+        return filled(windAbove[t.bottom]) ? INSIDE : OUTSIDE;
+    }
+    
+    bool isInsideGrid(const Point& point) const {
+        if (point.x < gridMinX || point.y < gridMinY ||
+            point.x > gridMinX + cols * cellW || point.y > gridMinY + rows * cellH) {
+            return false;
+        }
+        int cell = cellIndex(clampCol(point.x), clampRow(point.y));
+        if (cellStart[cell] == cellStart[cell + 1]) {
+            return filled(cellWinding[cell]);
+        }
+        if (onCellEdge(point, cell)) {
+            return false;
+        }
+        return filled(cellWinding[cell] + windingDelta(point, cellRef[cell], cell));
     }
     
 public:
     void setPolygon(const vector<Point>& poly) {
-        polygon = poly;
+        setRings(poly, vector<int>{0, (int)poly.size()});
+    }
+    
+    // Several rings (shells and holes) in one flat array: ring r is
+    // vertices[ringStart[r]] .. vertices[ringStart[r + 1] - 1]. Queries
+    // see all of them in a single pass, combined under the fill rule.
+    void setRings(const vector<Point>& vertices, const vector<int>& ringStart, FillRule rule = EVEN_ODD) {
+        polygon = vertices;
+        fillRule = rule;
+        nextVertex.resize(polygon.size());
+        for (size_t r = 0; r + 1 < ringStart.size(); r++) {
+            for (int i = ringStart[r]; i < ringStart[r + 1]; i++) {
+                nextVertex[i] = i + 1 < ringStart[r + 1] ? i + 1 : ringStart[r];
+            }
+        }
+        simpleRings = !edgesMeet();
+        buildGrid();
+        buildSoA();
+        // The map is only needed up front when checkPoint() falls back to
+        // it; locate() builds it on first use otherwise.
+        nodes.clear();
+        if (simpleRings && !useGrid && (int)polygon.size() >= GRID_MIN_EDGES) {
+            buildTrapezoidMap();
+        }
     }
     
     bool checkPoint(const Point& point) const {
+        if (useGrid) return isInsideGrid(point);
+        if (!nodes.empty()) return locateInMap(point) == INSIDE;
         return isInside(point);
     }
+    
+    // Classifies a point with the trapezoidal map: O(log n) expected per
+    // query. Rings whose edges meet get the crossing loop instead, which
+    // does not depend on how the edges lie.
+    PointLocation locate(const Point& point) {
+        if (!simpleRings) {
+            bool onEdge;
+            int winding = windingNumber(point, onEdge);
+            return onEdge ? ON_BOUNDARY : filled(winding) ? INSIDE : OUTSIDE;
+        }
+        if (nodes.empty()) buildTrapezoidMap();
+        return locateInMap(point);
+    }
+    
+    // Runs the crossing test four queries at a time over the SoA edges; used
+    // for polygons too small for the sweep or the grid to pay off.
+    vector<bool> checkPointsBlocked(const vector<Point>& queries) const {
+        vector<bool> results(queries.size());
+        bool block[4];
+        for (size_t i = 0; i < queries.size(); i += 4) {
+            size_t count = min<size_t>(4, queries.size() - i);
+            insideBlock(&queries[i], count, block);
+            for (size_t k = 0; k < count; k++) {
+                results[i + k] = block[k];
+            }
+        }
+        return results;
+    }
+    
+    // Answers all queries at once by sweeping upwards over the polygon's
+    // edges, keeping the edges that span the sweep line ordered by x. Each
+    // edge records the winding number just to its left when it is inserted,
+    // and a query takes the one of the nearest edge to its right. That
+    // number cannot change while the edge is active only because no two
+    // edges cross, so rings whose edges meet are answered one query at a
+    // time instead. O((n + m) log(n + m)).
+    vector<bool> checkPoints(const vector<Point>& queries) const {
+        int n = polygon.size();
+        vector<bool> results(queries.size(), false);
+        if (n <= SIMD_MAX_EDGES) {
+            return checkPointsBlocked(queries);
+        }
+        if (!simpleRings) {
+            for (size_t i = 0; i < queries.size(); i++) {
+                results[i] = checkPoint(queries[i]);
+            }
+            return results;
+        }
+        
+        vector<Point> vertices = polygon;
+        sort(vertices.begin(), vertices.end(), pointLess);
+        
+        struct HorizontalEdge {
+            double y, minX, maxX;
+            bool operator<(const HorizontalEdge& other) const {
+                return y < other.y || (y == other.y && minX < other.minX);
+            }
+        };
+        vector<HorizontalEdge> horizontal;
+        vector<int> byBottom, byTop;
+        for (int i = 0; i < n; i++) {
+            const Point& a = polygon[i];
+            const Point& b = polygon[nextVertex[i]];
+            if (fabs(a.y - b.y) < EPS) {
+                horizontal.push_back({a.y, min(a.x, b.x), max(a.x, b.x)});
+            } else {
+                byBottom.push_back(i);
+                byTop.push_back(i);
+            }
+        }
+        sort(horizontal.begin(), horizontal.end());
+        auto bottomY = [&](int e) { return min(polygon[e].y, polygon[nextVertex[e]].y); };
+        auto topY = [&](int e) { return max(polygon[e].y, polygon[nextVertex[e]].y); };
+        auto direction = [&](int e) { return polygon[nextVertex[e]].y > polygon[e].y ? 1 : -1; };
+        // Edges starting at one height go in left to right (and by slope at a
+        // shared vertex), so each sees every edge to its left on insertion.
+        double startY = 0;
+        ActiveEdgeLess atStart(polygon, nextVertex, startY);
+        sort(byBottom.begin(), byBottom.end(), [&](int a, int b) {
+            if (bottomY(a) != bottomY(b)) return bottomY(a) < bottomY(b);
+            startY = bottomY(a);
+            return atStart(a, b);
+        });
+        sort(byTop.begin(), byTop.end(), [&](int a, int b) { return topY(a) < topY(b); });
+        
+        vector<int> order(queries.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        sort(order.begin(), order.end(), [&](int a, int b) { return queries[a].y < queries[b].y; });
+        
+        double sweepY = 0;
+        ActiveEdgeLess less(polygon, nextVertex, sweepY);
+        set<int, ActiveEdgeLess> active(less);
+        vector<set<int, ActiveEdgeLess>::iterator> where(n, active.end());
+        vector<int> windLeft(n, 0);
+        size_t nextBottom = 0, nextTop = 0;
+        
+        for (int qi : order) {
+            const Point& q = queries[qi];
+            
+            // Edges are active on [bottom, top). Events up to the query are
+            // replayed in height order, retiring before inserting at equal
+            // heights, so each new edge sees the edges really beside it.
+            while (true) {
+                bool retire = nextTop < byTop.size() && topY(byTop[nextTop]) <= q.y;
+                bool insert = nextBottom < byBottom.size() && bottomY(byBottom[nextBottom]) <= q.y;
+                if (retire && insert && bottomY(byBottom[nextBottom]) < topY(byTop[nextTop])) retire = false;
+                if (retire) {
+                    int e = byTop[nextTop++];
+                    if (where[e] != active.end()) {
+                        active.erase(where[e]);
+                        where[e] = active.end();
+                    }
+                } else if (insert) {
+                    int e = byBottom[nextBottom++];
+                    sweepY = bottomY(e);
+                    auto it = active.insert(e).first;
+                    where[e] = it;
+                    windLeft[e] = it == active.begin() ? 0 : windLeft[*prev(it)] - direction(*prev(it));
+                } else {
+                    break;
+                }
+            }
+            sweepY = q.y;
+            
+            if (isVertex(vertices, q) || onHorizontalEdge(horizontal, q)) continue;
+            
+            auto right = active.upper_bound(q);
+            bool onEdge = false;
+            if (right != active.end()) {
+                int e = *right;
+                onEdge = isOnEdge(q, polygon[e], polygon[nextVertex[e]]);
+            }
+            if (right != active.begin()) {
+                int e = *prev(right);
+                onEdge = onEdge || isOnEdge(q, polygon[e], polygon[nextVertex[e]]);
+            }
+            if (onEdge || right == active.end()) continue;
+            
+            results[qi] = filled(windLeft[*right]);
+        }
+        
+        return results;
+    }
 };
 
 int main(int argc, char* argv[]) {
+    // --locate reports boundary points separately, using the trapezoidal map.
+    // --nonzero fills by winding number instead of even-odd parity.
     string filename;
-    if (argc > 1) {
-        filename = argv[1];
-    } else {
+    bool threeWay = false;
+    FillRule rule = EVEN_ODD;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--locate") {
+            threeWay = true;
+        } else if (arg == "--nonzero") {
+            rule = NON_ZERO;
+        } else {
+            filename = arg;
+        }
+    }
+    if (filename.empty()) {
         cout << "Enter filename: ";
         cin >> filename;
     }
@@ -85,7 +1088,10 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // In the polygon section any line that is not a point (e.g. "hole")
+    // closes the current ring and starts the next one.
     vector<Point> polygonPoints;
+    vector<int> ringStart(1, 0);
     vector<Point> queryPoints;
     string line;
     bool readingPolygon = true;
@@ -104,11 +1110,22 @@ int main(int argc, char* argv[]) {
             } else {
                 queryPoints.push_back(Point(x, y));
             }
+        } else if (readingPolygon && (int)polygonPoints.size() > ringStart.back()) {
+            ringStart.push_back(polygonPoints.size());
         }
     }
     file.close();
+    if ((int)polygonPoints.size() > ringStart.back()) {
+        ringStart.push_back(polygonPoints.size());
+    }
     
-    if (polygonPoints.size() < 3) {
+    for (size_t r = 0; r + 1 < ringStart.size(); r++) {
+        if (ringStart[r + 1] - ringStart[r] < 3) {
+            cerr << "Error: Polygon must have at least 3 points" << endl;
+            return 1;
+        }
+    }
+    if (polygonPoints.empty()) {
         cerr << "Error: Polygon must have at least 3 points" << endl;
         return 1;
     }
@@ -119,17 +1136,36 @@ int main(int argc, char* argv[]) {
     }
     
     PointInPolygon checker;
-    checker.setPolygon(polygonPoints);
+    checker.setRings(polygonPoints, ringStart, rule);
     
     cout << "Polygon points: " << polygonPoints.size() << endl;
+    if (ringStart.size() > 2) {
+        cout << "Rings: " << ringStart.size() - 1 << endl;
+    }
     cout << "Query points: " << queryPoints.size() << endl;
     cout << "\nResults:" << endl;
     
+    // With many queries it is cheaper to answer them all in one sweep.
+    const size_t BATCH_MIN_QUERIES = 1024;
+    vector<bool> batch;
+    if (!threeWay && queryPoints.size() >= BATCH_MIN_QUERIES) {
+        batch = checker.checkPoints(queryPoints);
+    }
+    
     bool allInside = true;
     for (size_t i = 0; i < queryPoints.size(); i++) {
-        bool inside = checker.checkPoint(queryPoints[i]);
+        bool inside;
+        string label;
+        if (threeWay) {
+            PointLocation location = checker.locate(queryPoints[i]);
+            inside = location == INSIDE;
+            label = inside ? "INSIDE" : location == OUTSIDE ? "OUTSIDE" : "ON BOUNDARY";
+        } else {
+            inside = batch.empty() ? checker.checkPoint(queryPoints[i]) : batch[i];
+            label = inside ? "INSIDE" : "OUTSIDE/ON BOUNDARY";
+        }
         cout << "Point " << (i+1) << " (" << queryPoints[i].x << ", " 
-                  << queryPoints[i].y << "): " << (inside ? "INSIDE" : "OUTSIDE/ON BOUNDARY") << endl;
+                  << queryPoints[i].y << "): " << label << endl;
         if (!inside) {
             allInside = false;
         }
@@ -3,7 +3,19 @@
 #include <fstream>
 #include <algorithm>
 #include <climits>
+#include <limits>
+#include <cstdlib>
+#include <cerrno>
+#include <cctype>
 #include <cmath>
+#include <string>
+#include <thread>
+#include <set>
+#include <sstream>
+#include <chrono>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #define PROJECT_NAME = "chull"
 
@@ -11,41 +23,164 @@ using namespace std;
 
 const double EPS = 1e-2;
 
-struct Point {
-    double x, y;
+__extension__ typedef __int128 int128;
+
+// Coordinates are double (compared with EPS) or int / long long (exact).
+template <typename T>
+struct PointT {
+    T x, y;
     
-    Point() : x(0.0), y(0.0) {}
-    Point(double x, double y) : x(x), y(y) {}
+    PointT() : x(0), y(0) {}
+    PointT(T x, T y) : x(x), y(y) {}
     
-    bool operator==(const Point& other) const {
+    bool operator==(const PointT& other) const {
         return abs(x - other.x) < EPS && abs(y - other.y) < EPS;
     }
 };
 
-int orientation(const Point& p, const Point& q, const Point& r) {
-    double val = (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
+typedef PointT<double> Point;
+
+// diff holds a coordinate difference, wide a product of two differences.
+// Integer coordinates get exact 128-bit cross products; long long
+// coordinates must stay strictly within +-2^62 so that differences fit,
+// which coordinateFits() checks on input.
+template <typename T> struct CoordTraits;
+template <> struct CoordTraits<double> {
+    typedef double diff;
+    typedef double wide;
+};
+template <> struct CoordTraits<int> {
+    typedef long long diff;
+    typedef int128 wide;
+};
+template <> struct CoordTraits<long long> {
+    typedef long long diff;
+    typedef int128 wide;
+};
+
+template <typename T>
+bool coordinateFits(T) {
+    return true;
+}
+
+template <>
+inline bool coordinateFits(long long v) {
+    const long long LIMIT = 1LL << 62;
+    return -LIMIT < v && v < LIMIT;
+}
+
+inline int orientationSign(double val) {
     if (abs(val) < EPS) return 0;
     return (val > 0) ? 1 : 2;
 }
 
-double distSquared(const Point& p1, const Point& p2) {
-    return (p1.x - p2.x) * (p1.x - p2.x) + (p1.y - p2.y) * (p1.y - p2.y);
+inline int orientationSign(int128 val) {
+    if (val == 0) return 0;
+    return (val > 0) ? 1 : 2;
 }
 
-vector<Point> convexHull(vector<Point>& points) {
-    int n = points.size();
-    
-    if (n < 3) return points;
-    
+template <typename T>
+int orientation(const PointT<T>& p, const PointT<T>& q, const PointT<T>& r) {
+    typedef typename CoordTraits<T>::diff D;
+    typedef typename CoordTraits<T>::wide W;
+    W val = (W)((D)q.y - p.y) * ((D)r.x - q.x) - (W)((D)q.x - p.x) * ((D)r.y - q.y);
+    return orientationSign(val);
+}
+
+// orientation() with no EPS: a turn is collinear only when the determinant
+// is exactly zero. Integer coordinates are exact already. For doubles the
+// rounded determinant decides whenever it is clear of its error bound
+// (Shewchuk's ccwerrboundA); otherwise it is recomputed without rounding,
+// as a sum of exact products kept as a nonoverlapping expansion whose
+// largest component carries the sign.
+template <typename T>
+int exactOrientation(const PointT<T>& p, const PointT<T>& q, const PointT<T>& r) {
+    return orientation(p, q, r);
+}
+
+__attribute__((noinline)) int expansionOrientation(const Point& p, const Point& q, const Point& r) {
+    // The q.x * q.y terms of the two products cancel.
+    const double factors[6][2] = {{q.y, r.x}, {-p.y, r.x}, {p.y, q.x}, {-q.x, r.y}, {p.x, r.y}, {-p.x, q.y}};
+    double e[12];
+    int m = 0;
+    auto add = [&](double b) {
+        int k = 0;
+        for (int i = 0; i < m; i++) {
+            double s = b + e[i];
+            double bv = s - b;
+            double err = (b - (s - bv)) + (e[i] - bv);
+            if (err != 0) e[k++] = err;
+            b = s;
+        }
+        if (b != 0) e[k++] = b;
+        m = k;
+    };
+    for (const double* f : factors) {
+        double hi = f[0] * f[1];
+        add(fma(f[0], f[1], -hi));
+        add(hi);
+    }
+    if (m == 0) return 0;
+    return (e[m - 1] > 0) ? 1 : 2;
+}
+
+template <>
+inline int exactOrientation(const Point& p, const Point& q, const Point& r) {
+    double left = (q.y - p.y) * (r.x - q.x), right = (q.x - p.x) * (r.y - q.y);
+    double val = left - right;
+    if (abs(val) > 3.3306690738754716e-16 * (abs(left) + abs(right))) return (val > 0) ? 1 : 2;
+    return expansionOrientation(p, q, r);
+}
+
+template <typename T>
+typename CoordTraits<T>::wide distSquared(const PointT<T>& p1, const PointT<T>& p2) {
+    typedef typename CoordTraits<T>::diff D;
+    typedef typename CoordTraits<T>::wide W;
+    D dx = (D)p1.x - p2.x, dy = (D)p1.y - p2.y;
+    return (W)dx * dx + (W)dy * dy;
+}
+
+enum HullAlgorithm {
+    AUTO,
+    JARVIS,
+    MONOTONE_CHAIN,
+    CHAN
+};
+
+template <typename T>
+bool lexLess(const PointT<T>& a, const PointT<T>& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+template <typename T>
+bool samePoint(const PointT<T>& a, const PointT<T>& b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+template <typename T>
+int leftmostIndex(const vector<PointT<T>>& points) {
     int l = 0;
-    for (int i = 1; i < n; i++) {
+    for (int i = 1; i < (int)points.size(); i++) {
         if (points[i].x < points[l].x)
             l = i;
         else if (points[i].x == points[l].x && points[i].y < points[l].y)
             l = i;
     }
+    return l;
+}
+
+// Gift wrapping: O(nh). Starts at the leftmost (then lowest) point and
+// goes counterclockwise; of several collinear candidates the farthest wins,
+// so points in the middle of a hull edge are left out.
+template <typename T>
+vector<PointT<T>> jarvisMarch(vector<PointT<T>>& points) {
+    int n = points.size();
     
-    vector<Point> hull;
+    if (n < 3) return points;
+    
+    int l = leftmostIndex(points);
+    
+    vector<PointT<T>> hull;
     int p = l, q;
     
     do {
@@ -54,7 +189,7 @@ vector<Point> convexHull(vector<Point>& points) {
         q = (p + 1) % n;
         
         for (int i = 0; i < n; i++) {
-            int orient = orientation(points[p], points[i], points[q]);
+            int orient = exactOrientation(points[p], points[i], points[q]);
             
             if (orient == 2) {
                 q = i;
@@ -71,8 +206,771 @@ vector<Point> convexHull(vector<Point>& points) {
     return hull;
 }
 
-vector<Point> readPointsFromFile(const string& filename) {
-    vector<Point> points;
+// Andrew's monotone chain: O(n log n). Produces the same hull as
+// jarvisMarch (same start, same orientation, collinear points dropped).
+// orient decides which turns count as collinear.
+template <typename T>
+vector<PointT<T>> monotoneChain(const vector<PointT<T>>& input,
+                                int (*orient)(const PointT<T>&, const PointT<T>&, const PointT<T>&) = exactOrientation<T>) {
+    int n = input.size();
+    
+    if (n < 3) return input;
+    
+    vector<PointT<T>> points = input;
+    sort(points.begin(), points.end(), lexLess<T>);
+    
+    vector<PointT<T>> hull(2 * n);
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        while (k >= 2 && orient(hull[k - 2], hull[k - 1], points[i]) != 2) k--;
+        hull[k++] = points[i];
+    }
+    for (int i = n - 2, lower = k + 1; i >= 0; i--) {
+        while (k >= lower && orient(hull[k - 2], hull[k - 1], points[i]) != 2) k--;
+        hull[k++] = points[i];
+    }
+    hull.resize(max(k - 1, 1));
+    return hull;
+}
+
+// Whether candidate c should replace best as the next wrapping vertex
+// after p: it is more clockwise, or collinear and farther.
+template <typename T>
+bool wrapsBefore(const PointT<T>& p, const PointT<T>& c, const PointT<T>& best) {
+    int orient = exactOrientation(p, c, best);
+    return orient == 2 || (orient == 0 && distSquared(p, c) > distSquared(p, best));
+}
+
+template <typename T>
+int wrapScan(const vector<PointT<T>>& h, const PointT<T>& p) {
+    int best = -1;
+    for (int i = 0; i < (int)h.size(); i++) {
+        if (samePoint(h[i], p)) continue;
+        if (best < 0 || wrapsBefore(p, h[i], h[best])) best = i;
+    }
+    return best;
+}
+
+// Vertex of the convex polygon h (counterclockwise, no collinear
+// vertices) that wraps first from p, found by binary search over the
+// polygon's edges in O(log |h|). The answer is checked against its two
+// neighbours, which is enough on a convex polygon; degenerate cases (p a
+// vertex of h, or a search that does not settle) fall back to a scan.
+template <typename T>
+int wrapTangent(const vector<PointT<T>>& h, const PointT<T>& p) {
+    typedef typename CoordTraits<T>::diff D;
+    typedef typename CoordTraits<T>::wide W;
+    int n = h.size();
+    if (n < 3) return wrapScan(h, p);
+    
+    auto at = [&](int i) -> const PointT<T>& { return h[((i % n) + n) % n]; };
+    // > 0 when b is to the left of the ray p -> a.
+    auto turn = [&](const PointT<T>& a, const PointT<T>& b) {
+        return (W)((D)a.x - p.x) * ((D)b.y - p.y) - (W)((D)b.x - p.x) * ((D)a.y - p.y);
+    };
+    auto isTangent = [&](int i) {
+        return turn(at(i), at(i + 1)) >= 0 && turn(at(i), at(i - 1)) >= 0;
+    };
+    
+    int found = -1;
+    if (isTangent(0)) {
+        found = 0;
+    } else {
+        int a = 0, b = n;
+        for (int steps = 0; steps < 64 && b - a > 1; steps++) {
+            int c = (a + b) / 2;
+            if (isTangent(c)) {
+                found = c;
+                break;
+            }
+            bool upA = turn(at(a), at(a + 1)) < 0;
+            bool downC = turn(at(c), at(c + 1)) >= 0;
+            if (upA) {
+                if (downC || turn(at(a), at(c)) > 0) b = c;
+                else a = c;
+            } else {
+                if (!downC || turn(at(a), at(c)) > 0) a = c;
+                else b = c;
+            }
+        }
+    }
+    
+    if (found < 0 || samePoint(at(found), p) ||
+        wrapsBefore(p, at(found - 1), at(found)) || wrapsBefore(p, at(found + 1), at(found))) {
+        return wrapScan(h, p);
+    }
+    return ((found % n) + n) % n;
+}
+
+// Chan's algorithm: O(n log h). Guesses a hull size m, hulls groups of m
+// points with the monotone chain and gift-wraps over the group hulls,
+// finding each group's candidate by binary search. A wrap that has not
+// closed after m steps squares the guess and starts over.
+template <typename T>
+vector<PointT<T>> chanHull(const vector<PointT<T>>& points) {
+    int n = points.size();
+    
+    if (n < 3) return points;
+    
+    int l = leftmostIndex(points);
+    PointT<T> start = points[l];
+    // Starting small would rebuild the group hulls several times over
+    // for a hull of a few dozen points; 256 covers most inputs in one round.
+    for (long long m = min(256, n); ; m = min(m * m, (long long)n)) {
+        int groups = (n + m - 1) / m;
+        vector<vector<PointT<T>>> hulls(groups);
+        for (int g = 0; g < groups; g++) {
+            auto first = points.begin() + g * m;
+            auto last = points.begin() + min((long long)n, (g + 1) * m);
+            hulls[g] = monotoneChain(vector<PointT<T>>(first, last));
+        }
+        
+        vector<PointT<T>> hull;
+        // The current point is a vertex of its own group's hull (start is
+        // the first vertex of its group), where the candidate is simply the
+        // next vertex.
+        PointT<T> p = start;
+        int pg = l / m, pi = 0;
+        for (long long step = 0; step < m; step++) {
+            hull.push_back(p);
+            PointT<T> best = p;
+            int bestG = -1, bestI = -1;
+            for (int g = 0; g < groups; g++) {
+                const vector<PointT<T>>& h = hulls[g];
+                int t = g == pg ? (pi + 1) % (int)h.size() : wrapTangent(h, p);
+                if (t < 0 || samePoint(h[t], p)) continue;
+                if (bestG < 0 || wrapsBefore(p, h[t], best)) {
+                    best = h[t];
+                    bestG = g;
+                    bestI = t;
+                }
+            }
+            if (bestG < 0 || samePoint(best, start)) return hull;
+            p = best;
+            pg = bestG;
+            pi = bestI;
+        }
+        if (m == n) return hull;
+    }
+}
+
+// The hull of an evenly spread sample tells whether the hull is small
+// (Chan's algorithm wins) or holds a large share of the points, as for
+// points on a circle (the monotone chain wins).
+template <typename T>
+HullAlgorithm chooseAlgorithm(const vector<PointT<T>>& points) {
+    const int SAMPLE = 1024;
+    int n = points.size();
+    if (n < 4 * SAMPLE) return MONOTONE_CHAIN;
+    
+    vector<PointT<T>> sample;
+    for (int i = 0; i < SAMPLE; i++) {
+        sample.push_back(points[(long long)i * n / SAMPLE]);
+    }
+    int h = monotoneChain(sample).size();
+    return h * 8 > SAMPLE ? MONOTONE_CHAIN : CHAN;
+}
+
+// The algorithms build the hull with exactOrientation(), so they all find
+// the same vertices. With double coordinates orientation() then calls
+// turns within EPS straight; that test is not transitive, and applied
+// while building it would let interior points decide which near-collinear
+// vertices survive. Instead the EPS-flat vertices are dropped afterwards
+// by one pass over the exact hull alone.
+template <typename T>
+vector<PointT<T>> exactHull(vector<PointT<T>>& points, HullAlgorithm algorithm) {
+    if (algorithm == AUTO) algorithm = chooseAlgorithm(points);
+    switch (algorithm) {
+    case JARVIS:
+        return jarvisMarch(points);
+    case CHAN:
+        return chanHull(points);
+    default:
+        return monotoneChain(points);
+    }
+}
+
+template <typename T>
+vector<PointT<T>> dropFlatVertices(const vector<PointT<T>>& hull) {
+    return monotoneChain(hull, orientation<T>);
+}
+
+template <typename T>
+vector<PointT<T>> convexHull(vector<PointT<T>>& points, HullAlgorithm algorithm = AUTO) {
+    return dropFlatVertices(exactHull(points, algorithm));
+}
+
+// Hulls per-thread chunks of the input concurrently, then hulls the
+// concatenated partial hulls; every hull vertex is a vertex of its
+// chunk's hull, so the result is the same as hulling everything at once.
+// threads == 0 uses one thread per hardware core.
+template <typename T>
+vector<PointT<T>> parallelHull(const vector<PointT<T>>& points, int threads, HullAlgorithm algorithm = AUTO) {
+    const size_t MIN_CHUNK = 1 << 14;
+    size_t n = points.size();
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+    threads = (int)min((size_t)threads, max((size_t)1, n / MIN_CHUNK));
+    
+    vector<vector<PointT<T>>> partial(threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            vector<PointT<T>> chunk(points.begin() + n * t / threads, points.begin() + n * (t + 1) / threads);
+            partial[t] = exactHull(chunk, algorithm);
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    
+    vector<PointT<T>> merged;
+    for (const vector<PointT<T>>& h : partial) {
+        merged.insert(merged.end(), h.begin(), h.end());
+    }
+    return convexHull(merged, algorithm);
+}
+
+// Akl-Toussaint prefilter. The points extreme in the eight directions
+// (-1,0), (-1,-1), (0,-1), (1,-1), (1,0), (1,1), (0,1), (-1,1) span an
+// octagon, counterclockwise, that lies inside the hull; points strictly
+// inside it (exactOrientation 2 against every edge) cannot be vertices of
+// the exact hull, so the hull convexHull() derives from it is unchanged.
+template <typename K>
+void considerExtreme(K best[8], size_t at[8], int k, K key, size_t i) {
+    if (key > best[k] || (key == best[k] && i < at[k])) {
+        best[k] = key;
+        at[k] = i;
+    }
+}
+
+template <typename T, typename K>
+void considerExtremes(K best[8], size_t at[8], const PointT<T>& p, size_t i) {
+    K x = p.x, y = p.y;
+    considerExtreme(best, at, 0, -x, i);
+    considerExtreme(best, at, 1, -(x + y), i);
+    considerExtreme(best, at, 2, -y, i);
+    considerExtreme(best, at, 3, x - y, i);
+    considerExtreme(best, at, 4, x, i);
+    considerExtreme(best, at, 5, x + y, i);
+    considerExtreme(best, at, 6, y, i);
+    considerExtreme(best, at, 7, y - x, i);
+}
+
+// Vectorised passes exist for double coordinates only; they return how
+// many leading points they handled and the scalar loops do the rest.
+template <typename T, typename K>
+size_t extremeBlocks(const vector<PointT<T>>&, K*, size_t*) {
+    return 0;
+}
+
+template <typename T>
+size_t cullBlocks(const vector<PointT<T>>&, const vector<PointT<T>>&, vector<PointT<T>>&) {
+    return 0;
+}
+
+#ifdef __AVX2__
+// Two points per register as (x0, y0, x1, y1). Against the swapped
+// register (y0, x0, y1, x1) the sum gives x + y in every lane and the
+// difference gives x - y in even lanes and y - x in odd ones, so five
+// running maxima (with the index that reached them) cover all eight
+// directions.
+size_t extremeBlocks(const vector<Point>& points, double best[8], size_t at[8]) {
+    static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be two packed doubles");
+    size_t n = points.size(), i = 0;
+    const double* raw = &points[0].x;
+    const __m256d lowest = _mm256_set1_pd(-HUGE_VAL), zero = _mm256_setzero_pd();
+    __m256d hiV = lowest, hiNegV = lowest, hiDiff = lowest, hiSum = lowest, hiNegSum = lowest;
+    __m256d atV = zero, atNegV = zero, atDiff = zero, atSum = zero, atNegSum = zero;
+    __m256d idx = _mm256_setr_pd(0, 0, 1, 1);
+    const __m256d two = _mm256_set1_pd(2);
+    auto keep = [&](__m256d& hi, __m256d& hiAt, __m256d key) {
+        __m256d better = _mm256_cmp_pd(key, hi, _CMP_GT_OQ);
+        hi = _mm256_blendv_pd(hi, key, better);
+        hiAt = _mm256_blendv_pd(hiAt, idx, better);
+    };
+    for (; i + 2 <= n; i += 2) {
+        __m256d v = _mm256_loadu_pd(raw + 2 * i);
+        __m256d swapped = _mm256_permute_pd(v, 0x5);
+        __m256d sum = _mm256_add_pd(v, swapped);
+        keep(hiV, atV, v);
+        keep(hiNegV, atNegV, _mm256_sub_pd(zero, v));
+        keep(hiDiff, atDiff, _mm256_sub_pd(v, swapped));
+        keep(hiSum, atSum, sum);
+        keep(hiNegSum, atNegSum, _mm256_sub_pd(zero, sum));
+        idx = _mm256_add_pd(idx, two);
+    }
+    
+    // Lane l of each register belongs to direction laneDir[l].
+    const __m256d* his[5] = {&hiV, &hiNegV, &hiDiff, &hiSum, &hiNegSum};
+    const __m256d* ats[5] = {&atV, &atNegV, &atDiff, &atSum, &atNegSum};
+    const int laneDir[5][2] = {{4, 6}, {0, 2}, {3, 7}, {5, 5}, {1, 1}};
+    for (int r = 0; r < 5; r++) {
+        double keys[4], idxs[4];
+        _mm256_storeu_pd(keys, *his[r]);
+        _mm256_storeu_pd(idxs, *ats[r]);
+        for (int l = 0; l < 4; l++) {
+            if (keys[l] > -HUGE_VAL) considerExtreme(best, at, laneDir[r][l % 2], keys[l], (size_t)idxs[l]);
+        }
+    }
+    return i;
+}
+
+// Four points per step, deinterleaved into x = (x0, x2, x1, x3) and
+// y = (y0, y2, y1, y3). The edge test is the fast stage of
+// exactOrientation() written out: a point is culled when the value is
+// below minus its error bound for every edge, so each cull is certain and
+// points too close to call are left to the hull.
+size_t cullBlocks(const vector<Point>& points, const vector<Point>& octagon, vector<Point>& survivors) {
+    size_t n = points.size(), i = 0;
+    size_t edges = octagon.size();
+    __m256d ex[8], ey[8], edx[8], edy[8];
+    for (size_t j = 0; j < edges; j++) {
+        const Point& a = octagon[j];
+        const Point& b = octagon[(j + 1) % edges];
+        ex[j] = _mm256_set1_pd(b.x);
+        ey[j] = _mm256_set1_pd(b.y);
+        edx[j] = _mm256_set1_pd(b.x - a.x);
+        edy[j] = _mm256_set1_pd(b.y - a.y);
+    }
+    const double* raw = &points[0].x;
+    const __m256d negBound = _mm256_set1_pd(-3.3306690738754716e-16);
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const int lane[4] = {0, 2, 1, 3};
+    for (; i + 4 <= n; i += 4) {
+        __m256d p01 = _mm256_loadu_pd(raw + 2 * i), p23 = _mm256_loadu_pd(raw + 2 * i + 4);
+        __m256d px = _mm256_unpacklo_pd(p01, p23), py = _mm256_unpackhi_pd(p01, p23);
+        __m256d inside = all;
+        for (size_t j = 0; j < edges; j++) {
+            __m256d left = _mm256_mul_pd(edy[j], _mm256_sub_pd(px, ex[j]));
+            __m256d right = _mm256_mul_pd(edx[j], _mm256_sub_pd(py, ey[j]));
+            __m256d bound = _mm256_mul_pd(negBound, _mm256_add_pd(_mm256_andnot_pd(sign, left), _mm256_andnot_pd(sign, right)));
+            inside = _mm256_and_pd(inside, _mm256_cmp_pd(_mm256_sub_pd(left, right), bound, _CMP_LT_OQ));
+        }
+        int mask = _mm256_movemask_pd(inside);
+        for (int k = 0; k < 4; k++) {
+            if (!((mask >> lane[k]) & 1)) survivors.push_back(points[i + k]);
+        }
+    }
+    return i;
+}
+#endif
+
+template <typename T>
+vector<PointT<T>> extremeOctagon(const vector<PointT<T>>& points) {
+    typedef typename CoordTraits<T>::diff K;
+    vector<PointT<T>> octagon;
+    if (points.empty()) return octagon;
+    
+    K best[8];
+    size_t at[8];
+    for (int k = 0; k < 8; k++) {
+        best[k] = numeric_limits<K>::lowest();
+        at[k] = 0;
+    }
+    considerExtremes(best, at, points[0], 0);
+    for (size_t i = extremeBlocks(points, best, at); i < points.size(); i++) {
+        considerExtremes(best, at, points[i], i);
+    }
+    
+    for (int k = 0; k < 8; k++) {
+        const PointT<T>& p = points[at[k]];
+        if (octagon.empty() || !samePoint(octagon.back(), p)) octagon.push_back(p);
+    }
+    while (octagon.size() > 1 && samePoint(octagon.back(), octagon.front())) octagon.pop_back();
+    return octagon;
+}
+
+template <typename T>
+bool insideOctagon(const vector<PointT<T>>& octagon, const PointT<T>& p) {
+    for (size_t j = 0; j < octagon.size(); j++) {
+        if (exactOrientation(octagon[j], octagon[(j + 1) % octagon.size()], p) != 2) return false;
+    }
+    return true;
+}
+
+// Returns the points that survive the prefilter, in input order.
+template <typename T>
+vector<PointT<T>> aklToussaint(const vector<PointT<T>>& points) {
+    size_t n = points.size();
+    if (n < 8) return points;
+    
+    vector<PointT<T>> octagon = extremeOctagon(points);
+    if (octagon.size() < 3) return points;
+    
+    vector<PointT<T>> survivors;
+    for (size_t i = cullBlocks(points, octagon, survivors); i < n; i++) {
+        if (!insideOctagon(octagon, points[i])) survivors.push_back(points[i]);
+    }
+    return survivors;
+}
+
+// Convex layers (onion peeling): layer k holds the vertices of
+// convexHull() of the points left after removing layers 0..k-1, so points
+// in the middle of a hull edge fall to a deeper layer. The distinct points
+// sit in lexicographic order in buckets under a segment tree, and every
+// node keeps the exact upper and lower chains of its live points. Peeling
+// a layer reads the root's chains, flattens them like convexHull(), kills
+// the remaining vertices and re-merges only the nodes above them, instead
+// of hulling everything again. A re-merge still copies both child chains,
+// so a peel can cost O(n) per tree level and the worst case over all
+// layers is O(n^2 log n), not the O(n log n) of Chazelle's algorithm; it
+// pays off when layers are small next to n, as for uniform points.
+// layerIndex() gives the layer of each input point; duplicates share one.
+template <typename T>
+class ConvexLayers {
+public:
+    explicit ConvexLayers(const vector<PointT<T>>& input) : layerOf(input.size(), -1) {
+        int n = input.size();
+        vector<int> order(n);
+        for (int i = 0; i < n; i++) order[i] = i;
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return lexLess(input[a], input[b]); });
+        vector<int> slot(n);
+        for (int i = 0; i < n; i++) {
+            if (points.empty() || !samePoint(points.back(), input[order[i]])) points.push_back(input[order[i]]);
+            slot[order[i]] = points.size() - 1;
+        }
+        
+        int m = points.size();
+        layer.assign(m, -1);
+        buckets = (m + BUCKET - 1) / BUCKET;
+        size = 1;
+        while (size < buckets) size *= 2;
+        upper.resize(2 * size);
+        lower.resize(2 * size);
+        for (int v = 2 * size - 1; v >= 1; v--) rebuild(v);
+        
+        vector<char> dirty(2 * size, 0);
+        vector<int> nodes;
+        for (int k = 0; !upper[1].empty(); k++) {
+            vector<PointT<T>> hull;
+            for (int i : lower[1]) hull.push_back(points[i]);
+            for (int j = (int)upper[1].size() - 2; j > 0; j--) hull.push_back(points[upper[1][j]]);
+            nodes.clear();
+            for (const PointT<T>& p : dropFlatVertices(hull)) {
+                int i = lower_bound(points.begin(), points.end(), p, lexLess<T>) - points.begin();
+                layer[i] = k;
+                for (int v = size + i / BUCKET; v >= 1 && !dirty[v]; v /= 2) {
+                    dirty[v] = 1;
+                    nodes.push_back(v);
+                }
+            }
+            // Children have larger indices, so this merges bottom-up.
+            sort(nodes.rbegin(), nodes.rend());
+            for (int v : nodes) {
+                rebuild(v);
+                dirty[v] = 0;
+            }
+            layers = k + 1;
+        }
+        
+        for (int i = 0; i < n; i++) layerOf[i] = layer[slot[i]];
+    }
+    
+    const vector<int>& layerIndex() const {
+        return layerOf;
+    }
+    
+    int layerCount() const {
+        return layers;
+    }
+    
+private:
+    static const int BUCKET = 16;
+    
+    vector<PointT<T>> points;
+    vector<int> layer, layerOf;
+    vector<vector<int>> upper, lower;
+    int buckets, size, layers = 0;
+    
+    // Monotone-chain step: turn is 1 for the upper chain, 2 for the lower.
+    void push(vector<int>& chain, int i, int turn) const {
+        while (chain.size() >= 2 && exactOrientation(points[chain[chain.size() - 2]], points[chain.back()], points[i]) != turn) {
+            chain.pop_back();
+        }
+        chain.push_back(i);
+    }
+    
+    void rebuild(int v) {
+        upper[v].clear();
+        lower[v].clear();
+        if (v >= size) {
+            int b = v - size;
+            int end = min((int)points.size(), (b + 1) * BUCKET);
+            for (int i = b * BUCKET; i < end; i++) {
+                if (layer[i] >= 0) continue;
+                push(upper[v], i, 1);
+                push(lower[v], i, 2);
+            }
+            return;
+        }
+        // The left child's chain is already convex, so only the right
+        // child's points can pop anything.
+        upper[v] = upper[2 * v];
+        lower[v] = lower[2 * v];
+        for (int i : upper[2 * v + 1]) push(upper[v], i, 1);
+        for (int i : lower[2 * v + 1]) push(lower[v], i, 2);
+    }
+};
+
+struct Rectangle {
+    Point corners[4];
+    double area, perimeter;
+};
+
+struct CaliperReport {
+    Point farthestA, farthestB;
+    double diameter, width;
+    Rectangle minArea, minPerimeter;
+};
+
+template <typename T>
+Point toDouble(const PointT<T>& p) {
+    return Point(p.x, p.y);
+}
+
+// Rotating calipers over a hull as returned by convexHull (counterclockwise,
+// no collinear vertices), O(h). For every edge three calipers advance
+// monotonically: the vertex farthest from the edge line (top) and the
+// vertices extreme forwards and backwards along the edge (right, left).
+// The top vertex gives the antipodal pairs for the diameter and the width
+// with the edge flush; the other two complete the enclosing rectangle
+// with a side on the edge, which is where both minimal rectangles lie.
+template <typename T>
+CaliperReport rotatingCalipers(const vector<PointT<T>>& input) {
+    vector<Point> hull;
+    for (const PointT<T>& p : input) hull.push_back(toDouble(p));
+    int h = hull.size();
+    
+    CaliperReport report;
+    report.width = 0;
+    if (h < 3) {
+        Point a = h > 0 ? hull[0] : Point(), b = h > 1 ? hull[1] : a;
+        report.farthestA = a;
+        report.farthestB = b;
+        report.diameter = sqrt(distSquared(a, b));
+        Rectangle segment = {{a, b, b, a}, 0, 2 * report.diameter};
+        report.minArea = report.minPerimeter = segment;
+        return report;
+    }
+    
+    auto at = [&](int i) -> const Point& { return hull[i % h]; };
+    auto cross = [](const Point& a, const Point& b, const Point& c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    };
+    auto dot = [](const Point& a, const Point& b, const Point& c) {
+        return (b.x - a.x) * (c.x - a.x) + (b.y - a.y) * (c.y - a.y);
+    };
+    
+    double bestDiameter = -1;
+    report.width = report.minArea.area = report.minPerimeter.perimeter = HUGE_VAL;
+    for (int i = 0, top = 0, right = 0, left = 0; i < h; i++) {
+        const Point& a = at(i);
+        const Point& b = at(i + 1);
+        if (i == 0) {
+            while (dot(a, b, at(right + 1)) > dot(a, b, at(right))) right++;
+            top = right;
+        }
+        while (cross(a, b, at(top + 1)) > cross(a, b, at(top))) top++;
+        if (i == 0) left = top;
+        while (dot(a, b, at(left + 1)) < dot(a, b, at(left))) left++;
+        while (dot(a, b, at(right + 1)) > dot(a, b, at(right))) right++;
+        
+        for (const Point* end : {&a, &b}) {
+            double d = distSquared(*end, at(top));
+            if (d > bestDiameter) {
+                bestDiameter = d;
+                report.farthestA = *end;
+                report.farthestB = at(top);
+            }
+        }
+        
+        double len = sqrt(distSquared(a, b));
+        double ux = (b.x - a.x) / len, uy = (b.y - a.y) / len;
+        double lo = dot(a, b, at(left)) / len, hi = dot(a, b, at(right)) / len;
+        double height = cross(a, b, at(top)) / len;
+        report.width = min(report.width, height);
+        
+        Rectangle r;
+        r.corners[0] = Point(a.x + ux * lo, a.y + uy * lo);
+        r.corners[1] = Point(a.x + ux * hi, a.y + uy * hi);
+        r.corners[2] = Point(r.corners[1].x - uy * height, r.corners[1].y + ux * height);
+        r.corners[3] = Point(r.corners[0].x - uy * height, r.corners[0].y + ux * height);
+        r.area = (hi - lo) * height;
+        r.perimeter = 2 * (hi - lo + height);
+        if (r.area < report.minArea.area) report.minArea = r;
+        if (r.perimeter < report.minPerimeter.perimeter) report.minPerimeter = r;
+    }
+    report.diameter = sqrt(bestDiameter);
+    return report;
+}
+
+// Extreme-vertex and tangent queries on a hull as returned by convexHull,
+// O(log h) each, for callers that ask many of them against one hull. The
+// hull is split at its lexicographically last vertex into the lower and
+// upper chains, both kept left to right as indices into the hull. Along
+// the chain facing a direction the projection rises and then falls, so
+// the extreme vertex is the first one whose next edge stops climbing.
+// Internally the hull is rotated to start at its lexicographically first
+// vertex (convexHull returns fewer than three points in input order);
+// answers are indices into the hull as passed in.
+template <typename T>
+class HullQueries {
+public:
+    explicit HullQueries(const vector<PointT<T>>& input) {
+        int h = input.size();
+        start = h > 0 ? leftmostIndex(input) : 0;
+        for (int i = 0; i < h; i++) {
+            hull.push_back(input[(start + i) % h]);
+        }
+        int r = 0;
+        for (int i = 1; i < h; i++) {
+            if (lexLess(hull[r], hull[i])) r = i;
+        }
+        for (int i = 0; i <= r && h > 0; i++) lower.push_back(i);
+        upper.push_back(0);
+        for (int i = h - 1; i >= r && h > 1; i--) upper.push_back(i);
+    }
+    
+    // Index of a hull vertex with the largest dot product with d, or -1
+    // for an empty hull.
+    int extreme(const PointT<T>& d) const {
+        return original(extremeAlong(d.x, d.y));
+    }
+    
+    // Inside or on the boundary.
+    bool contains(const PointT<T>& q) const {
+        int h = hull.size();
+        if (h < 3) {
+            for (int i = 0; i < h; i++) {
+                if (samePoint(hull[i], q)) return true;
+            }
+            return h == 2 && orientation(hull[0], hull[1], q) == 0 && between(hull[0], hull[1], q);
+        }
+        if (q.x < hull[0].x || q.x > hull[lower.back()].x) return false;
+        return !beyond(lower, q, 1) && !beyond(upper, q, 2);
+    }
+    
+    // The vertices where the two tangent lines from q touch the hull, as
+    // (first, second): the hull lies right of the ray from q through first
+    // and left of the ray through second, and the edges q can see run
+    // counterclockwise from first to second. (-1, -1) if q is not outside.
+    pair<int, int> tangents(const PointT<T>& q) const {
+        pair<int, int> t = rotatedTangents(q);
+        return make_pair(original(t.first), original(t.second));
+    }
+    
+private:
+    typedef typename CoordTraits<T>::diff D;
+    typedef typename CoordTraits<T>::wide W;
+    
+    vector<PointT<T>> hull;
+    vector<int> lower, upper;
+    int start;
+    
+    int original(int i) const {
+        return i < 0 ? i : (i + start) % hull.size();
+    }
+    
+    pair<int, int> rotatedTangents(const PointT<T>& q) const {
+        int h = hull.size();
+        if (h == 0 || contains(q)) return make_pair(-1, -1);
+        if (h < 3) {
+            if (h == 1 || orientation(q, hull[0], hull[1]) != 2) return make_pair(0, h - 1);
+            return make_pair(1, 0);
+        }
+        
+        auto sees = [&](int i) { return orientation(hull[i], hull[(i + 1) % h], q) == 1; };
+        // The visible edges form one run and the hidden ones the rest, so
+        // given one edge of each, both ends of the run are binary searches.
+        // The vertex extreme against a visible edge's outward normal has a
+        // hidden edge on at least one side.
+        int seen = visibleEdge(q);
+        const PointT<T>& a = hull[seen];
+        const PointT<T>& b = hull[(seen + 1) % h];
+        int hidden = extremeAlong((D)a.y - b.y, (D)b.x - a.x);
+        if (sees(hidden)) hidden = (hidden + h - 1) % h;
+        
+        auto firstAfter = [&](int from, int to, bool visible) {
+            int lo = 1, hi = (to - from + h) % h;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (sees((from + mid) % h) == visible) hi = mid;
+                else lo = mid + 1;
+            }
+            return (from + lo) % h;
+        };
+        int first = firstAfter(hidden, seen, true);
+        int second = firstAfter(seen, hidden, false);
+        
+        // Coordinates compared with EPS can bend the runs; fall back to a
+        // scan rather than return a wrong vertex.
+        if (sees((first + h - 1) % h) || !sees(first) || !sees((second + h - 1) % h) || sees(second)) {
+            for (int i = 0; i < h; i++) {
+                bool before = sees((i + h - 1) % h), after = sees(i);
+                if (!before && after) first = i;
+                if (before && !after) second = i;
+            }
+        }
+        return make_pair(first, second);
+    }
+    
+    // Horizontal directions are answered by the chains' shared ends; the
+    // upper chain faces every direction pointing up, the lower one the rest.
+    int extremeAlong(D dx, D dy) const {
+        if (hull.empty()) return -1;
+        if (dy == 0) return dx > 0 ? lower.back() : 0;
+        const vector<int>& chain = dy > 0 ? upper : lower;
+        int lo = 0, hi = chain.size() - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            const PointT<T>& p = hull[chain[mid]];
+            const PointT<T>& q = hull[chain[mid + 1]];
+            W climb = (W)dx * ((D)q.x - p.x) + (W)dy * ((D)q.y - p.y);
+            if (climb > 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return chain[lo];
+    }
+    
+    static bool between(const PointT<T>& a, const PointT<T>& b, const PointT<T>& q) {
+        return min(a.x, b.x) <= q.x && q.x <= max(a.x, b.x) && min(a.y, b.y) <= q.y && q.y <= max(a.y, b.y);
+    }
+    
+    // Whether q is strictly outside the chain edge spanning q.x; turn is
+    // the orientation of a point outside the lower (1) or upper (2) chain.
+    // The only vertical edges are the lower chain's last and the upper
+    // chain's first, and neither is the one to test.
+    bool beyond(const vector<int>& chain, const PointT<T>& q, int turn) const {
+        int lo = 0, hi = chain.size() - 2;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (hull[chain[mid + 1]].x >= q.x) hi = mid;
+            else lo = mid + 1;
+        }
+        if (hull[chain[lo]].x == hull[chain[lo + 1]].x) lo++;
+        return orientation(hull[chain[lo]], hull[chain[lo + 1]], q) == turn;
+    }
+    
+    // An edge an outside point q can see: one at vertex 0, or else the far
+    // side of the fan triangle from vertex 0 that contains q's direction.
+    int visibleEdge(const PointT<T>& q) const {
+        int h = hull.size();
+        if (orientation(hull[0], hull[1], q) == 1) return 0;
+        if (orientation(hull[h - 1], hull[0], q) == 1) return h - 1;
+        int lo = 1, hi = h - 2;
+        while (lo < hi) {
+            int mid = (lo + hi + 1) / 2;
+            if (orientation(hull[0], hull[mid], q) != 1) lo = mid;
+            else hi = mid - 1;
+        }
+        return lo;
+    }
+};
+
+// With integer coordinates a value such as "0.5" stops the read; that is
+// reported rather than hulling a truncated input.
+template <typename T>
+vector<PointT<T>> readPointsFromFile(const string& filename) {
+    vector<PointT<T>> points;
     ifstream file(filename);
     
     if (!file.is_open()) {
@@ -80,45 +978,547 @@ vector<Point> readPointsFromFile(const string& filename) {
         return points;
     }
     
-    double x, y;
-    while (file >> x >> y) {
-        points.emplace_back(x, y);
+    T x, y;
+    bool fits = true;
+    while (fits && file >> x >> y) {
+        fits = coordinateFits(x) && coordinateFits(y);
+        if (fits) points.emplace_back(x, y);
+    }
+    if (!fits) {
+        cerr << "Error: Point " << points.size() + 1 << " in " << filename
+             << " is out of range; integer coordinates must lie strictly within +-2^62" << endl;
+        points.clear();
+    } else if (!file.eof()) {
+        cerr << "Error: Could not read the coordinates after point " << points.size() << " in " << filename << endl;
+        points.clear();
     }
     
     file.close();
     return points;
 }
 
-void printPoints(const vector<Point>& points) {
-    for (const Point& p : points) {
+// Hulls a point file that does not fit in memory: reads chunkSize points
+// at a time and hulls each chunk together with the running hull, so at
+// most chunkSize + h points are held at once. Progress goes to stderr
+// after every chunk.
+vector<Point> streamingHull(const string& filename, size_t chunkSize, HullAlgorithm algorithm, bool prefilter) {
+    vector<Point> hull;
+    ifstream file(filename);
+    
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return hull;
+    }
+    
+    auto start = chrono::steady_clock::now();
+    size_t total = 0;
+    vector<Point> chunk;
+    double x, y;
+    while (file) {
+        chunk.assign(hull.begin(), hull.end());
+        size_t read = 0;
+        while (read < chunkSize && file >> x >> y) {
+            chunk.emplace_back(x, y);
+            read++;
+        }
+        if (read == 0) break;
+        total += read;
+        
+        if (prefilter) chunk = aklToussaint(chunk);
+        hull = exactHull(chunk, algorithm);
+        
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << "Streamed " << total << " points, hull " << hull.size() << " points, "
+             << (long long)(total / max(elapsed, 1e-9)) << " points/s" << endl;
+    }
+    
+    file.close();
+    return dropFlatVertices(hull);
+}
+
+// epsilon-kernel: the points extreme in k evenly spaced directions, with
+// k of order 1/sqrt(eps). Their hull is within about eps times the hull's
+// extent of the true hull, and errorBound() measures the actual gap: each
+// true hull point lies in the triangle between two neighbouring extremes
+// and the corner where their supporting lines meet.
+class DirectionalExtremes {
+public:
+    explicit DirectionalExtremes(double eps) {
+        const double PI = acos(-1.0);
+        // A multiple of 8, so the axis and diagonal directions are included.
+        int k = 8 * max(1, (int)ceil(2 * PI / sqrt(eps) / 8));
+        for (int i = 0; i < k; i++) {
+            ux.push_back(cos(2 * PI * i / k));
+            uy.push_back(sin(2 * PI * i / k));
+        }
+        best.assign(k, -HUGE_VAL);
+        at.assign(k, Point());
+    }
+    
+    void add(const Point& p) {
+        for (size_t i = 0; i < ux.size(); i++) {
+            double key = ux[i] * p.x + uy[i] * p.y;
+            if (key > best[i]) {
+                best[i] = key;
+                at[i] = p;
+            }
+        }
+    }
+    
+    size_t directions() const {
+        return ux.size();
+    }
+    
+    vector<Point> coreSet() const {
+        vector<Point> core;
+        if (best[0] == -HUGE_VAL) return core;
+        for (const Point& p : at) {
+            if (core.empty() || !samePoint(core.back(), p)) core.push_back(p);
+        }
+        while (core.size() > 1 && samePoint(core.back(), core.front())) core.pop_back();
+        return core;
+    }
+    
+    double errorBound() const {
+        double bound = 0;
+        if (best[0] == -HUGE_VAL) return bound;
+        size_t k = ux.size();
+        for (size_t i = 0; i < k; i++) {
+            size_t j = (i + 1) % k;
+            const Point& a = at[i];
+            const Point& b = at[j];
+            if (samePoint(a, b)) continue;
+            double det = ux[i] * uy[j] - uy[i] * ux[j];
+            double cx = (best[i] * uy[j] - uy[i] * best[j]) / det;
+            double cy = (ux[i] * best[j] - best[i] * ux[j]) / det;
+            double ex = b.x - a.x, ey = b.y - a.y;
+            bound = max(bound, abs(ex * (cy - a.y) - ey * (cx - a.x)) / sqrt(ex * ex + ey * ey));
+        }
+        return bound;
+    }
+    
+private:
+    vector<double> ux, uy, best;
+    vector<Point> at;
+};
+
+// Approximate hull in one pass over the file: chunks go through the
+// octagon prefilter (culled points are extreme in no direction) and the
+// survivors update the directional extremes; only the core set is hulled.
+vector<Point> approximateHull(const string& filename, size_t chunkSize, DirectionalExtremes& extremes, size_t& total) {
+    vector<Point> hull;
+    ifstream file(filename);
+    total = 0;
+    
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return hull;
+    }
+    
+    vector<Point> chunk;
+    double x, y;
+    while (file) {
+        chunk.clear();
+        while (chunk.size() < chunkSize && file >> x >> y) {
+            chunk.emplace_back(x, y);
+        }
+        total += chunk.size();
+        for (const Point& p : aklToussaint(chunk)) {
+            extremes.add(p);
+        }
+    }
+    
+    file.close();
+    vector<Point> core = extremes.coreSet();
+    return convexHull(core, MONOTONE_CHAIN);
+}
+
+template <typename T>
+void printPoints(const vector<PointT<T>>& points) {
+    for (const PointT<T>& p : points) {
         cout << p.x << " " << p.y << endl;
     }
 }
 
-int main(int argc, char* argv[]) {
-    string filename;
-    if (argc > 1) {
-        filename = argv[1];
-    } else {
-        cout << "Enter filename: ";
-        cin >> filename;
+struct LexCompare {
+    bool operator()(const Point& a, const Point& b) const {
+        return lexLess(a, b);
+    }
+};
+
+// Hull of a changing point set. The lower and upper chains are kept in
+// lexicographic order, each with strict turns by exactOrientation(), so
+// together they form the exact hull, and the snapshot flattens it the way
+// convexHull() does. Inserting costs amortised O(log n). Erasing a
+// point that is not a hull vertex is O(log n); erasing a vertex rebuilds
+// its chain between the two neighbouring vertices from the live points in
+// that slab.
+class DynamicHull {
+public:
+    void insert(const Point& p) {
+        points.insert(p);
+        addToChain(lower, p, 2);
+        addToChain(upper, p, 1);
+    }
+    
+    bool erase(const Point& p) {
+        auto it = points.find(p);
+        if (it == points.end()) return false;
+        points.erase(it);
+        if (points.count(p)) return true;
+        repairChain(lower, p, 2);
+        repairChain(upper, p, 1);
+        return true;
+    }
+    
+    // Counterclockwise from the leftmost (then lowest) point, like
+    // convexHull().
+    vector<Point> snapshot() const {
+        vector<Point> hull(lower.begin(), lower.end());
+        if (upper.size() > 2) hull.insert(hull.end(), next(upper.rbegin()), prev(upper.rend()));
+        return dropFlatVertices(hull);
+    }
+    
+    size_t size() const {
+        return points.size();
     }
     
-    vector<Point> points = readPointsFromFile(filename);
+private:
+    typedef set<Point, LexCompare> Chain;
+    
+    multiset<Point, LexCompare> points;
+    Chain lower, upper;
+    
+    // turn is the orientation every three consecutive chain vertices must
+    // have left to right: 2 for the lower chain, 1 for the upper.
+    static void addToChain(Chain& chain, const Point& p, int turn) {
+        if (chain.count(p)) return;
+        auto after = chain.lower_bound(p);
+        if (after != chain.begin() && after != chain.end() && exactOrientation(*prev(after), p, *after) != turn) return;
+        
+        auto it = chain.insert(after, p);
+        while (it != chain.begin()) {
+            auto before = prev(it);
+            if (before == chain.begin() || exactOrientation(*prev(before), *before, p) == turn) break;
+            chain.erase(before);
+        }
+        while (true) {
+            auto following = next(it);
+            if (following == chain.end() || next(following) == chain.end() ||
+                exactOrientation(p, *following, *next(following)) == turn) break;
+            chain.erase(following);
+        }
+    }
+    
+    // Removing a vertex keeps its neighbours on the chain, and only points
+    // strictly between them can take its place.
+    void repairChain(Chain& chain, const Point& p, int turn) {
+        auto it = chain.find(p);
+        if (it == chain.end()) return;
+        auto from = it == chain.begin() ? points.begin() : points.upper_bound(*prev(it));
+        auto to = next(it) == chain.end() ? points.end() : points.lower_bound(*next(it));
+        chain.erase(it);
+        for (auto q = from; q != to; ++q) {
+            addToChain(chain, *q, turn);
+        }
+    }
+};
+
+// Replays an operation log against a DynamicHull: one operation per line,
+// "insert x y", "erase x y" or "hull" to print the current hull.
+bool runDynamic(const string& filename) {
+    ifstream file(filename);
+    
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return false;
+    }
+    
+    DynamicHull dynamic;
+    string line;
+    while (getline(file, line)) {
+        istringstream ss(line);
+        string op;
+        double x, y;
+        if (!(ss >> op)) continue;
+        if (op == "insert" && ss >> x >> y) {
+            dynamic.insert(Point(x, y));
+        } else if (op == "erase" && ss >> x >> y) {
+            if (!dynamic.erase(Point(x, y))) cerr << "Point " << x << " " << y << " is not in the set" << endl;
+        } else if (op == "hull") {
+            vector<Point> hull = dynamic.snapshot();
+            cout << "Convex Hull (" << hull.size() << " of " << dynamic.size() << " points):" << endl;
+            printPoints(hull);
+            cout << endl;
+        } else {
+            cerr << "Unknown operation: " << line << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void printRectangle(const string& name, const Rectangle& r) {
+    cout << name << " rectangle (area " << r.area << ", perimeter " << r.perimeter << "):" << endl;
+    for (const Point& p : r.corners) {
+        cout << p.x << " " << p.y << endl;
+    }
+}
+
+template <typename T>
+void printCalipers(const vector<PointT<T>>& hull) {
+    CaliperReport report = rotatingCalipers(hull);
+    cout << endl;
+    cout << "Diameter: " << report.diameter << " between " << report.farthestA.x << " " << report.farthestA.y
+         << " and " << report.farthestB.x << " " << report.farthestB.y << endl;
+    cout << "Width: " << report.width << endl;
+    printRectangle("Minimum-area", report.minArea);
+    printRectangle("Minimum-perimeter", report.minPerimeter);
+}
+
+// Answers a query log against a computed hull: one query per line,
+// "extreme dx dy" for the vertex farthest along a direction or
+// "tangents x y" for the tangent vertices from a point. A line may end
+// with the expected answer ("x y", "x1 y1 x2 y2" or "none" for a point
+// that is not outside); a different answer fails the run, which is how
+// the test cases check themselves.
+template <typename T>
+bool runQueries(const vector<PointT<T>>& hull, const string& filename) {
+    ifstream file(filename);
+    
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return false;
+    }
+    
+    HullQueries<T> queries(hull);
+    cout << endl;
+    string line;
+    while (getline(file, line)) {
+        istringstream ss(line);
+        string op;
+        T x, y;
+        if (!(ss >> op)) continue;
+        vector<PointT<T>> answer;
+        if (!(ss >> x >> y) || !coordinateFits(x) || !coordinateFits(y)) {
+            cerr << "Invalid query: " << line << endl;
+            return false;
+        }
+        if (op == "extreme") {
+            const PointT<T>& p = hull[queries.extreme(PointT<T>(x, y))];
+            cout << "Extreme vertex along " << x << " " << y << ": " << p.x << " " << p.y << endl;
+            answer.push_back(p);
+        } else if (op == "tangents") {
+            pair<int, int> t = queries.tangents(PointT<T>(x, y));
+            if (t.first < 0) {
+                cout << "Point " << x << " " << y << " is not outside the hull" << endl;
+            } else {
+                const PointT<T>& a = hull[t.first];
+                const PointT<T>& b = hull[t.second];
+                cout << "Tangents from " << x << " " << y << ": " << a.x << " " << a.y << " and " << b.x << " " << b.y << endl;
+                answer.push_back(a);
+                answer.push_back(b);
+            }
+        } else {
+            cerr << "Unknown query: " << line << endl;
+            return false;
+        }
+        
+        string word;
+        if (!(ss >> word)) continue;
+        bool matches;
+        if (word == "none") {
+            matches = answer.empty();
+        } else {
+            istringstream expected(word + " " + string(istreambuf_iterator<char>(ss), {}));
+            matches = !answer.empty();
+            for (const PointT<T>& p : answer) {
+                matches = matches && expected >> x >> y && samePoint(p, PointT<T>(x, y));
+            }
+        }
+        if (!matches) {
+            cerr << "Answer differs from the expected one: " << line << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads, optionally prefilters and hulls (or peels) a point file with
+// coordinate type T; --int64 selects the exact integer path.
+template <typename T>
+int runHull(const string& filename, HullAlgorithm algorithm, bool prefilter, int threads, bool calipers, bool layers,
+            const string& queries) {
+    vector<PointT<T>> points = readPointsFromFile<T>(filename);
     
     if (points.empty()) {
         cerr << "No points found in file or file could not be read." << endl;
         return 1;
     }
     
+    if (layers) {
+        ConvexLayers<T> onion(points);
+        cout << "Convex Layers (" << onion.layerCount() << " layers):" << endl;
+        for (size_t i = 0; i < points.size(); i++) {
+            cout << points[i].x << " " << points[i].y << " " << onion.layerIndex()[i] << endl;
+        }
+        return 0;
+    }
+    
     cout << "Input points (" << points.size() << " points):" << endl;
     printPoints(points);
     cout << endl;
     
-    vector<Point> hull = convexHull(points);
+    if (prefilter) {
+        size_t total = points.size();
+        points = aklToussaint(points);
+        cout << "Prefilter culled " << total - points.size() << " of " << total << " points" << endl;
+        cout << endl;
+    }
+    
+    vector<PointT<T>> hull = threads == 1 ? convexHull(points, algorithm) : parallelHull(points, threads, algorithm);
     
     cout << "Convex Hull (" << hull.size() << " points):" << endl;
     printPoints(hull);
+    if (calipers) printCalipers(hull);
+    if (!queries.empty() && !runQueries(hull, queries)) return 1;
     
     return 0;
+}
+
+// Option values must be numbers in full: "8x" or "-1" is an error, not 8
+// or a huge count.
+bool parseCount(const string& text, size_t& value) {
+    char* end;
+    errno = 0;
+    unsigned long long parsed = strtoull(text.c_str(), &end, 10);
+    if (text.empty() || !isdigit((unsigned char)text[0]) || *end != '\0' || errno == ERANGE) return false;
+    value = parsed;
+    return true;
+}
+
+bool parseDouble(const string& text, double& value) {
+    char* end;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && isfinite(value);
+}
+
+int main(int argc, char* argv[]) {
+    string filename;
+    HullAlgorithm algorithm = AUTO;
+    bool prefilter = true;
+    bool dynamicLog = false;
+    bool integer = false;
+    int threads = 1;
+    size_t streamChunk = 0;
+    double approxEps = 0;
+    bool calipers = false;
+    bool layers = false;
+    string queryFile;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--dynamic") {
+            dynamicLog = true;
+        } else if (arg == "--int64") {
+            integer = true;
+        } else if (arg == "--layers") {
+            layers = true;
+        } else if (arg == "--calipers") {
+            calipers = true;
+        } else if (arg == "--queries" && i + 1 < argc) {
+            queryFile = argv[++i];
+        } else if (arg == "--no-prefilter") {
+            prefilter = false;
+        } else if (arg == "--stream") {
+            if (i + 1 >= argc || !parseCount(argv[++i], streamChunk) || streamChunk == 0) {
+                cerr << "--stream needs a chunk size of at least 1 point" << endl;
+                return 1;
+            }
+        } else if (arg == "--approx") {
+            if (i + 1 >= argc || !parseDouble(argv[++i], approxEps) || !(approxEps > 0 && approxEps < 1)) {
+                cerr << "--approx needs an epsilon between 0 and 1" << endl;
+                return 1;
+            }
+        } else if (arg == "--threads") {
+            size_t count;
+            if (i + 1 >= argc || !parseCount(argv[++i], count) || count > INT_MAX) {
+                cerr << "--threads needs a thread count (0 for one per core)" << endl;
+                return 1;
+            }
+            threads = count;
+        } else if (arg == "--algo" && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "jarvis") algorithm = JARVIS;
+            else if (name == "monotone") algorithm = MONOTONE_CHAIN;
+            else if (name == "chan") algorithm = CHAN;
+            else if (name == "auto") algorithm = AUTO;
+            else {
+                cerr << "Unknown algorithm " << name << " (jarvis, monotone, chan, auto)" << endl;
+                return 1;
+            }
+        } else {
+            filename = arg;
+        }
+    }
+    bool chunked = streamChunk > 0 || approxEps > 0;
+    if (chunked && (integer || layers || threads != 1)) {
+        cerr << "--stream and --approx read double coordinates in one thread; "
+             << "they cannot be combined with --int64, --layers or --threads" << endl;
+        return 1;
+    }
+    if (approxEps > 0 && (algorithm != AUTO || !prefilter)) {
+        cerr << "--approx always prefilters and hulls its core set with the monotone chain; "
+             << "it cannot be combined with --algo or --no-prefilter" << endl;
+        return 1;
+    }
+    if (dynamicLog && (integer || chunked || layers || calipers || threads != 1 || !queryFile.empty() ||
+                       algorithm != AUTO || !prefilter)) {
+        cerr << "--dynamic replays an operation log and takes no other options" << endl;
+        return 1;
+    }
+    if (filename.empty()) {
+        cout << "Enter filename: ";
+        cin >> filename;
+    }
+    
+    if (dynamicLog) {
+        return runDynamic(filename) ? 0 : 1;
+    }
+    
+    if (approxEps > 0) {
+        DirectionalExtremes extremes(approxEps);
+        size_t total;
+        vector<Point> hull = approximateHull(filename, streamChunk > 0 ? streamChunk : 1 << 16, extremes, total);
+        if (hull.empty()) {
+            cerr << "No points found in file or file could not be read." << endl;
+            return 1;
+        }
+        cout << "Core set: " << extremes.coreSet().size() << " of " << total << " points ("
+             << extremes.directions() << " directions)" << endl;
+        cout << "Error bound: " << extremes.errorBound() << endl;
+        cout << endl;
+        cout << "Convex Hull (" << hull.size() << " points):" << endl;
+        printPoints(hull);
+        if (calipers) printCalipers(hull);
+        if (!queryFile.empty() && !runQueries(hull, queryFile)) return 1;
+        return 0;
+    }
+    
+    if (streamChunk > 0) {
+        vector<Point> hull = streamingHull(filename, streamChunk, algorithm, prefilter);
+        if (hull.empty()) {
+            cerr << "No points found in file or file could not be read." << endl;
+            return 1;
+        }
+        cout << "Convex Hull (" << hull.size() << " points):" << endl;
+        printPoints(hull);
+        if (calipers) printCalipers(hull);
+        if (!queryFile.empty() && !runQueries(hull, queryFile)) return 1;
+        return 0;
+    }
+    
+    if (integer) {
+        return runHull<long long>(filename, algorithm, prefilter, threads, calipers, layers, queryFile);
+    }
+    return runHull<double>(filename, algorithm, prefilter, threads, calipers, layers, queryFile);
 }
\ No newline at end of file